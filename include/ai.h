@@ -0,0 +1,205 @@
+/**
+ * @file ai.h
+ *
+ * @authors Philipp Karg (philipp.karg@tum.de)
+ *
+ * @brief Header file for ai.c.
+ * @date 16.10.2026
+ * @copyright Philipp Karg 2022
+ */
+
+/**
+ * @defgroup ai AI Module
+ * @ingroup tetris
+ * @brief Module that plays the game without a human on the keyboard.
+ *
+ * For every new Tetromino, all of its final positions are enumerated with iLogicGetPlacements().
+ * Each of them is tried on a copy of the board & rated with a weighted sum of
+ * the aggregate height, the number of holes, the bumpiness, the row & column transitions & the rows cleared.
+ * The features of the boards are computed in batches by the @ref evaluate "Evaluation Module".
+ * The best one is then played by returning one @ref game_input_t per step,
+ * just like a human pressing the buttons.
+ *
+ * Optionally, an @ref ai_search_t looks further ahead with a beam search:
+ * the best boards after the current Tetromino are expanded with the upcoming ones,
+ * i.e. the next Tetromino & the types pending from the opponent or waiting in the bag.
+ * The boards of each level are expanded in parallel on a @ref pool "Thread Pool"
+ * & the search stops at the last complete level, once its time budget has run out.
+ * Boards, that are reached in different ways, are recognized by their hash & only kept once per level.
+ * On the last level, only the best rating of each board is needed,
+ * which is cached in a shared @ref table "Transposition Table", so that later searches can reuse it.
+ *
+ * @authors Philipp Karg (philipp.karg@tum.de)
+ * @date 16.10.2026
+ * @copyright Philipp Karg 2022
+ * @{
+ */
+
+#ifndef AI_H
+#define AI_H
+
+#include "engine.h"
+#include "evaluate.h"
+#include "threadPool.h"
+#include "transTable.h"
+
+/**
+ * @name Beam Search
+ * @{
+ */
+#define AI_BEAM_WIDTH 16        ///< Default number of boards kept per level
+#define AI_BEAM_DEPTH 3         ///< Default number of Tetrominos placed, including the current one
+#define AI_MAX_DEPTH 8          ///< Upper bound for the depth of a search
+#define AI_SEARCH_BUDGET 10     ///< Default time budget of one search in ms
+#define AI_TABLE_BITS 16        ///< The transposition table of a search has 2^AI_TABLE_BITS entries
+///@}
+
+/**
+ * @brief Opaque structure representing a beam search, see pxAISearchCreate().
+ */
+typedef struct ai_search ai_search_t;
+
+/**
+ * @brief Weights of the features, that a board is rated with.
+ */
+typedef struct ai_weights
+{
+    float height;       ///< Weight of the sum of all column heights
+    float holes;        ///< Weight of the number of holes
+    float bumpiness;    ///< Weight of the sum of the height differences of neighbouring columns
+    float rows;         ///< Weight of the number of rows cleared
+    float rowTransitions;       ///< Weight of the changes between empty & occupied squares along the rows
+    float columnTransitions;    ///< Weight of the changes between empty & occupied squares along the columns
+} ai_weights_t;
+
+/**
+ * @brief Number of weights in @ref ai_weights_t.
+ */
+#define AI_WEIGHTS (sizeof(ai_weights_t) / sizeof(float))
+
+/**
+ * @brief Default weights, tuned to clear as many rows as possible.
+ *
+ * The transitions are not used by default, they are meant to be tuned.
+ */
+#define AI_DEFAULT_WEIGHTS ((ai_weights_t){ -0.510066f, -0.35663f, -0.184483f, 0.760666f, 0.0f, 0.0f })
+
+/**
+ * @brief State of an AI player.
+ */
+typedef struct ai_player
+{
+    ai_weights_t weights;   ///< Weights of the board evaluation
+    ai_search_t *search;    ///< Beam search, NULL to only rate the placements of the current Tetromino
+    placement_t target;     ///< Placement the current Tetromino is moved to
+    bool planned;           ///< Whether a placement was chosen for the current Tetromino
+    uint8_t moves;          ///< Number of inputs for the current Tetromino
+} ai_player_t;
+
+/**
+ * @brief Initialize an AI player.
+ * @param[out] ai ( @ref ai_player_t *): AI player to initialize.
+ * @param[in] weights (const @ref ai_weights_t *): Weights of the board evaluation, NULL for #AI_DEFAULT_WEIGHTS.
+ * @param[in] search ( @ref ai_search_t *): Beam search to plan with, NULL to only rate the current Tetromino.
+ */
+void vAIInit(ai_player_t *ai, const ai_weights_t *weights, ai_search_t *search);
+
+/**
+ * @brief Read weights from a file, e.g. #AI_WEIGHTS_FILE.
+ *
+ * Each line contains the name of a field of @ref ai_weights_t & its value, e.g. `holes -0.35663`.
+ * Empty lines & lines starting with `#` are skipped, weights missing in the file keep their value.
+ * @param[in] path (const char*): Path of the file.
+ * @param[inout] weights ( @ref ai_weights_t *): Weights to read into.
+ * @return (bool): True if the file was read, false if it could not be opened or contains an unknown line.
+ */
+bool bAILoadWeights(const char *path, ai_weights_t *weights);
+
+/**
+ * @brief Write weights to a file, in the format of bAILoadWeights().
+ * @param[in] path (const char*): Path of the file.
+ * @param[in] weights (const @ref ai_weights_t *): Weights to write.
+ * @return (bool): True if the file was written.
+ */
+bool bAISaveWeights(const char *path, const ai_weights_t *weights);
+
+/**
+ * @brief Rate a board, higher is better.
+ * @param[in] features (const @ref board_features_t *): Features of the board, see vEvaluateBoards().
+ * @param[in] rows (int): Number of rows that were cleared to get to this board.
+ * @param[in] weights (const @ref ai_weights_t *): Weights of the features.
+ * @return (float): The rating.
+ */
+float fAIEvaluate(const board_features_t *features, int rows, const ai_weights_t *weights);
+
+/**
+ * @brief Find the best placement for @p tetromino.
+ * @param[in] tetromino (const @ref tetromino_t *): Tetromino to place.
+ * @param[in] landed (const @ref board_t *): Board of landed Tetrominos.
+ * @param[in] rotationMode ( @ref rotation_t): Rotation mode of the game.
+ * @param[in] weights (const @ref ai_weights_t *): Weights of the board evaluation.
+ * @param[out] best ( @ref placement_t *): The best placement.
+ * @return (bool): false if @p tetromino cannot be placed anywhere.
+ */
+bool bAIFindPlacement(  const tetromino_t *tetromino,
+                        const board_t *landed,
+                        rotation_t rotationMode,
+                        const ai_weights_t *weights,
+                        placement_t *best);
+
+/**
+ * @brief Create a beam search.
+ * @param[in] width (int): Number of boards kept per level.
+ * @param[in] depth (int): Number of Tetrominos placed, including the current one, at most #AI_MAX_DEPTH.
+ * @param[in] budget (uint32_t): Time budget of one search in ms, 0 for no limit.
+ * @param[in] pool ( @ref thread_pool_t *): Thread pool to expand the boards on, NULL to expand them in the calling thread.
+ * @return ( @ref ai_search_t *): The search, NULL upon failure.
+ */
+ai_search_t *pxAISearchCreate(int width, int depth, uint32_t budget, thread_pool_t *pool);
+
+/**
+ * @brief Free @p search, the thread pool is not deleted.
+ * @param[in] search ( @ref ai_search_t *): Search to delete.
+ */
+void vAISearchDelete(ai_search_t *search);
+
+/**
+ * @brief Find the best placement for the current Tetromino of @p state with a beam search.
+ *
+ * -# Get the upcoming Tetrominos, predicting their spawn rotation from a copy of the game's generator.
+ * -# Place the current Tetromino in all possible ways.
+ * -# For each upcoming Tetromino, place it on each board of the beam in all possible ways,
+ *    & keep the distinct boards with the best rating as the new beam.
+ * -# For the last Tetromino, only get the best rating of each board, from the transposition table if possible.
+ * -# Return the first placement that leads to the best board of the last complete level.
+ *
+ * The time budget is limited to half the delay for updating the position,
+ * so that the search always finishes before the Tetromino falls, even on high levels.
+ * @param[in] search ( @ref ai_search_t *): The search.
+ * @param[in] state (const @ref game_state_t *): The game.
+ * @param[in] weights (const @ref ai_weights_t *): Weights of the board evaluation.
+ * @param[out] best ( @ref placement_t *): The best placement.
+ * @return (bool): false if the current Tetromino cannot be placed anywhere.
+ */
+bool bAISearch( ai_search_t *search,
+                const game_state_t *state,
+                const ai_weights_t *weights,
+                placement_t *best);
+
+/**
+ * @brief Get the AI player's input for the next step of @p state.
+ *
+ * -# If the current Tetromino has no placement yet, choose one with bAISearch() or bAIFindPlacement().
+ * -# Rotate until the Tetromino has the placement's shape.
+ * -# Move it left/right until it is in the placement's column.
+ * -# Hard drop it.
+ *
+ * If the Tetromino gets stuck on the way, it is dropped where it is.
+ * @param[inout] ai ( @ref ai_player_t *): The AI player.
+ * @param[in] state (const @ref game_state_t *): The game.
+ * @return ( @ref game_input_t): The input for bEngineStep().
+ */
+game_input_t xAIGetInput(ai_player_t *ai, const game_state_t *state);
+
+///@}
+#endif // AI_H
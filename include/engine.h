@@ -0,0 +1,147 @@
+/**
+ * @file engine.h
+ * 
+ * @authors Philipp Karg (philipp.karg@tum.de)
+ * 
+ * @brief Header file for engine.c.
+ * @date 16.10.2026
+ * @copyright Philipp Karg 2022
+ */
+
+/**
+ * @defgroup engine Engine Module
+ * @ingroup tetris
+ * @brief Module that advances a game without any tasks, timers or drawing.
+ * 
+ * The complete state of a running game is kept in a @ref game_state_t.
+ * The game is advanced by calling bEngineStep() with the current input & the time that has passed,
+ * which replaces the FreeRTOS timers & signals with elapsed-time counters.
+ * The @ref game "Game Module" drives the engine once per frame,
+ * but it can be driven by anything else as well, e.g. to simulate games as fast as possible.
+ * 
+ * @authors Philipp Karg (philipp.karg@tum.de)
+ * @date 16.10.2026
+ * @copyright Philipp Karg 2022
+ * @{
+ */
+
+#ifndef ENGINE_H
+#define ENGINE_H
+
+#include "logic.h"
+
+/**
+ * @name Delays
+ * @{
+ */
+#define POS_UPDATE_DELAY 500    ///< Initial value for the delay for updating a Tetromino's position
+#define DELAY_AT_BOTTOM 300     ///< Initial value for the delay when a Tetromino hits the bottom
+#define MIN_DELAY 20            ///< Lower bound for both delays on high levels
+///@}
+
+/**
+ * @name Input
+ * Bits of a @ref game_input_t.
+ * @{
+ */
+#define ENGINE_INPUT_LEFT   (1 << 0)    ///< Move the Tetromino to the left
+#define ENGINE_INPUT_RIGHT  (1 << 1)    ///< Move the Tetromino to the right
+#define ENGINE_INPUT_ROTATE (1 << 2)    ///< Rotate the Tetromino
+#define ENGINE_INPUT_DOWN   (1 << 3)    ///< Move the Tetromino down
+#define ENGINE_INPUT_DROP   (1 << 4)    ///< Drop the Tetromino to its landing row & lock it immediately
+///@}
+
+/**
+ * @name Events
+ * Bits of @ref game_state_t::events, set by bEngineStep().
+ * @{
+ */
+#define ENGINE_EVENT_FALL       (1 << 0)    ///< The Tetromino could not fall any further
+#define ENGINE_EVENT_GROUND     (1 << 1)    ///< The Tetromino hit the ground & the delay at the ground started
+#define ENGINE_EVENT_LOCK       (1 << 2)    ///< The Tetromino was added to the landed ones & the next one was initialized
+#define ENGINE_EVENT_ROWS       (1 << 3)    ///< One or more rows were cleared
+#define ENGINE_EVENT_GAME_OVER  (1 << 4)    ///< The game is over
+#define ENGINE_EVENT_NO_TYPE    (1 << 5)    ///< In multiplayer mode, no type was pending for the next Tetromino
+///@}
+
+/**
+ * @brief Bitmask of the player's input for one step, see #ENGINE_INPUT_LEFT etc.
+ */
+typedef uint8_t game_input_t;
+
+/**
+ * @brief Structure containing the complete state of a game.
+ */
+typedef struct game_state
+{
+    board_t landed;                 ///< Board of landed Tetrominos
+    tetromino_t current;            ///< Current Tetromino
+    tetromino_t next;               ///< Upcoming Tetromino
+    bag_t bag;                      ///< Bag of upcoming Tetromino types for a fairer game
+    score_t score;                  ///< The score
+    uint32_t seed;                  ///< Seed of the game, to reproduce it
+    rng_t rng;                      ///< Random number generator of the game
+    player_mode_t playerMode;       ///< Player mode of the game
+    rotation_t rotationMode;        ///< Rotation mode of the game
+    /// In multiplayer mode, the next type received from the opponent, #NO_TYPE if none is pending
+    tetromino_type_t pendingType;
+
+    uint32_t gravityElapsed;        ///< Time since the Tetromino last fell, in ms
+    uint32_t gravityPeriod;         ///< Time between two falls, in ms
+    uint32_t groundElapsed;         ///< Time since the delay at the ground was (re-)started, in ms
+    uint32_t groundPeriod;          ///< Duration of the delay at the ground, in ms
+    bool gravityPending;            ///< Whether the Tetromino should fall in the next possible step
+    bool groundDelayActive;         ///< Whether the delay at the ground is running
+    bool okNext;                    ///< Whether the Tetromino could not move down the last time it tried
+    bool startDelay;                ///< Whether the delay at the ground can be started
+    bool gameOver;                  ///< Whether the game is over
+    uint8_t events;                 ///< Events of the last step, see #ENGINE_EVENT_FALL etc.
+    /// Mask of the rows cleared in the last step, bit n for row n counted from the bottom
+    uint16_t clearedRows;
+} game_state_t;
+
+/**
+ * @brief Initialize a new game.
+ * 
+ * -# Reset the board & the score.
+ * -# Seed the game's random number generator with @p seed & the bag of Tetromino types from it.
+ * -# Initialize the current & the upcoming Tetromino with vLogicInitTetromino().
+ * -# Start the delay for updating the position, depending on the @p level.
+ * 
+ * @param[out] state ( @ref game_state_t *): Game to initialize.
+ * @param[in] playerMode ( @ref player_mode_t): Player mode of the game.
+ * @param[in] rotationMode ( @ref rotation_t): Rotation mode of the game.
+ * @param[in] level (uint8_t): Starting level.
+ * @param[in] types (const @ref tetromino_type_t []): In multiplayer mode,
+ * the types of the current & upcoming Tetromino, NULL otherwise.
+ * @param[in] seed (uint32_t): Seed of the game, the same seed always leads to the same game.
+ */
+void vEngineInit(   game_state_t *state,
+                    player_mode_t playerMode,
+                    rotation_t rotationMode,
+                    uint8_t level,
+                    const tetromino_type_t types[2],
+                    uint32_t seed);
+
+/**
+ * @brief Advance the game by @p dt milliseconds.
+ * 
+ * -# If the game is over, return.
+ * -# Advance the delays for updating the position & at the ground.
+ * -# Restart the delay at the ground, if a button is pressed or the Tetromino can move down.
+ * -# Move & rotate the Tetromino depending on @p input, let it fall if the delay has run out.
+ * -# On a hard drop, move the Tetromino to its landing row with iLogicDropDistance() & lock it.
+ * -# If the Tetromino hits the ground, start the delay at the ground.
+ * -# If that delay has run out, add the Tetromino to the landed ones & initialize the next one.
+ * 
+ * Like the FreeRTOS timers the delays replace, each of them triggers at most once per step.
+ * The events that occurred are stored in @ref game_state_t::events.
+ * @param[inout] state ( @ref game_state_t *): Game to advance.
+ * @param[in] input ( @ref game_input_t): The player's input.
+ * @param[in] dt (uint32_t): Time passed since the last step, in ms.
+ * @return (bool): false if the game is over, true otherwise.
+ */
+bool bEngineStep(game_state_t *state, game_input_t input, uint32_t dt);
+
+///@}
+#endif //ENGINE_H
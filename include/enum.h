@@ -79,7 +79,8 @@ typedef enum player_mode
 {
     NO_PLAYER = 0,
     SINGLE_PLAYER = 1,
-    MULTI_PLAYER = 2
+    MULTI_PLAYER = 2,
+    AI_PLAYER = 3
 } player_mode_t;
 
 ///@}
@@ -0,0 +1,74 @@
+/**
+ * @file evaluate.h
+ * 
+ * @authors Philipp Karg (philipp.karg@tum.de)
+ * 
+ * @brief Header file for evaluate.c.
+ * @date 16.10.2026
+ * @copyright Philipp Karg 2022
+ */
+
+/**
+ * @defgroup evaluate Evaluation Module
+ * @ingroup tetris
+ * @brief Module that computes the features of many boards at once.
+ * 
+ * Every feature is a sum of per-row popcounts, walking the rows from the top
+ * & OR-ing them into a mask of the squares, that are covered or occupied:
+ * - Aggregate height: the covered or occupied squares.
+ * - Holes: the covered squares, that are empty.
+ * - Bumpiness: neighbouring columns, of which only one is covered or occupied.
+ * - Row transitions: changes between empty & occupied squares along a row, the walls count as occupied.
+ * - Column transitions: changes between empty & occupied squares along a column, the ground counts as occupied.
+ * 
+ * The boards of a batch are transposed, so that row n of #EVALUATE_BATCH boards is held in one register,
+ * one board per 16-bit lane. Depending on the CPU, AVX2 or SSE2 is used, with a scalar fallback.
+ * 
+ * @authors Philipp Karg (philipp.karg@tum.de)
+ * @date 16.10.2026
+ * @copyright Philipp Karg 2022
+ * @{
+ */
+
+#ifndef EVALUATE_H
+#define EVALUATE_H
+
+#include "logic.h"
+
+#define EVALUATE_BATCH 16   ///< Number of boards, that are evaluated at once
+
+#if ROWS > 16
+#error "The evaluation sums up to 16 rows in 16-bit lanes"
+#endif
+
+/**
+ * @brief Features of a board.
+ */
+typedef struct board_features
+{
+    uint16_t height;            ///< Sum of all column heights
+    uint16_t holes;             ///< Number of empty squares below the highest occupied square of their column
+    uint16_t bumpiness;         ///< Sum of the height differences of neighbouring columns
+    uint16_t rowTransitions;    ///< Number of changes between empty & occupied squares along the rows
+    uint16_t columnTransitions; ///< Number of changes between empty & occupied squares along the columns
+} board_features_t;
+
+/**
+ * @brief Compute the features of @p count boards.
+ * 
+ * The boards are evaluated in batches of #EVALUATE_BATCH.
+ * Only the row masks of the boards are read, not their caches.
+ * @param[in] boards (const @ref board_t *const []): The boards.
+ * @param[in] count (int): Number of boards.
+ * @param[out] features ( @ref board_features_t []): The features of each board.
+ */
+void vEvaluateBoards(const board_t *const boards[], int count, board_features_t features[]);
+
+/**
+ * @brief Get the name of the kernel vEvaluateBoards() uses on this CPU.
+ * @return (const char*): "AVX2", "SSE2" or "scalar".
+ */
+const char *pcEvaluateGetKernel(void);
+
+///@}
+#endif // EVALUATE_H
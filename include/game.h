@@ -12,7 +12,7 @@
  * @brief Module that contains the primary game functionality
  * 
  * This module contains the game's main functionality. It contains the different tasks, for the main game, main menu & pause screen.
- * It interacts with the @ref logic "Logic Module", the @ref gui "GUI Module" , the @ref state "State Machine Module" and the @ref opponent "Opponent Module".
+ * It interacts with the @ref engine "Engine Module", the @ref ai "AI Module", the @ref logic "Logic Module", the @ref gui "GUI Module" , the @ref state "State Machine Module" and the @ref opponent "Opponent Module".
  * 
  * @authors Philipp Karg (philipp.karg@tum.de)
  * @date 04.02.2021
@@ -41,9 +41,9 @@ extern TaskHandle_t ScoreTask;
 extern QueueHandle_t ConnectionQueue;
 extern QueueHandle_t GameModeQueue;
 extern QueueHandle_t TetrominoQueue;
+extern QueueHandle_t SeedQueue;
 
 // Semaphore Handles ****************************************************************
-extern SemaphoreHandle_t ScreenLock;
 extern SemaphoreHandle_t DrawSignal;
 extern SemaphoreHandle_t ResetGameSignal;
 extern SemaphoreHandle_t ResetUDPSignal;
@@ -54,7 +54,7 @@ extern SemaphoreHandle_t NoConnectionSignal;
  * @brief Initialize the game.
  * 
  * - Load the sound samples.
- * - Create #ScreenLock & #DrawSignal Semaphores.
+ * - Create #DrawSignal Semaphore.
  * - Create #MainMenuTask, #GameTask, #PauseTask & #ScoreTask.
  * 
  * @return (int): 0 upon successful initialization, -1 otherwise.
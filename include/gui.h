@@ -38,6 +38,19 @@
 #define MODES_HEIGHT 500
 ///@}
 
+/**
+ * @name Square images, see vGUISetImageHandle().
+ * 
+ * The images of the Tetromino colors are followed by the image of the wall
+ * & an atlas containing all of them, in the same order.
+ * @{
+ */
+#define WALL_SQUARE NUMBER_OF_TETRIS_COLORS                     ///< Index of the wall's image
+#define NUMBER_OF_SQUARE_IMAGES (NUMBER_OF_TETRIS_COLORS + 1)   ///< Number of square images
+#define SQUARE_ATLAS NUMBER_OF_SQUARE_IMAGES                    ///< Index of the atlas of all square images
+#define NUMBER_OF_IMAGE_HANDLES (NUMBER_OF_SQUARE_IMAGES + 1)   ///< Number of image handles, including the atlas
+///@}
+
 // **********************************************************************************
 // Menus & Screens ******************************************************************
 // **********************************************************************************
@@ -67,7 +80,9 @@ bool bGUIDrawLevelScreen(uint8_t *currentLevel, const score_t highScores[]);
 
 /**
  * @brief Draw the wall, score, level & number of lines completed.
- * @param[in] squares (const @ref image_handle_t): Array containing the square images. 
+ * 
+ * The wall is drawn from its pre-loaded image, so that no file is read while drawing.
+ * @param[in] squares (const @ref image_handle_t): Array containing the square images, including the wall. 
  * @param[in] score (const @ref score_t): Score object 
  */
 void vGUIDrawStatic(const image_handle_t squares[], const score_t *score);
@@ -119,19 +134,30 @@ bool bGUIDrawLevelMenuSelection(void);
 /**
  * @brief Draw the current Tetromino.
  * 
- * Iterate through the Tetrominos's @ref tetromino_t::shape "shape array" 
- * and draw each existing entry in the Tetromino's @ref color_t "color".
+ * Iterate through the squares of the Tetrominos's @ref tetromino_t::shape "shape" 
+ * and draw each of them in the Tetromino's @ref color_t "color".
  * @param[in] tetromino (const @ref tetromino_t *): Tetromino object to draw.
  * @param[in] squares (const @ref image_handle_t []): Array containing the square images. 
  */
 void vGUIDrawTetromino(const tetromino_t *tetromino, const image_handle_t squares[]);
 
 /**
- * @brief Draw the array of landed tetrominos.
- * @param[in] landed (const @ref color_t [][]): Array of landed Tetrominos. 
+ * @brief Draw the ghost piece, i.e. the outline of @p tetromino where it would land.
+ * 
+ * The landing row is looked up with iLogicDropDistance(), instead of moving the Tetromino down row by row.
+ * @param[in] tetromino (const @ref tetromino_t *): The current Tetromino.
+ * @param[in] landed (const @ref board_t *): Board of landed Tetrominos. 
+ */
+void vGUIDrawGhost(const tetromino_t *tetromino, const board_t *landed);
+
+/**
+ * @brief Draw the board of landed tetrominos.
+ * 
+ * Empty rows are skipped using the row masks, the squares are drawn from the board's color plane.
+ * @param[in] landed (const @ref board_t *): Board of landed Tetrominos. 
  * @param[in] squares (const @ref image_handle_t []): Array containing the square images. 
  */
-void vGUIDrawLanded(const color_t landed[ROWS][COLS], const image_handle_t squares[]);
+void vGUIDrawLanded(const board_t *landed, const image_handle_t squares[]);
 
 /**
  * @brief Draw the upcoming Tetromino in the upper right corner.
@@ -150,7 +176,10 @@ void vGUIDrawFPS(void);
 
 /**
  * @brief Takes an @ref image_handle_t array & initializes it with the correct images
- * @param[out] squares ( @ref image_handle_t []): Array to initialize
+ * 
+ * The squares are drawn in batches from the atlas at #SQUARE_ATLAS.
+ * If it could not be created, the squares are drawn one by one from their own images.
+ * @param[out] squares ( @ref image_handle_t []): Array of #NUMBER_OF_IMAGE_HANDLES images to initialize
  */
 void vGUISetImageHandle(image_handle_t squares[]);
 
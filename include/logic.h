@@ -28,6 +28,17 @@
 #include "tetrisConfig.h"
 
 #define EMPTY_SPACE 0 ///< If an tetromino does not contain a block in specific position, the value is set to 0
+#define TETROMINO_SQUARES 4     ///< Number of squares every Tetromino consists of
+#define NUMBER_OF_ROTATIONS 4   ///< Number of different rotations of a Tetromino
+#define NUMBER_OF_TYPES 7       ///< Number of Tetromino types, each bag contains every type once
+#define BAG_CAPACITY 32         ///< Number of types a @ref bag_t can hold, must be a power of 2
+#define BAG_MAX_PREVIEW (BAG_CAPACITY - NUMBER_OF_TYPES) ///< Maximum depth for eLogicBagPeek()
+#define FULL_ROW ((1 << COLS) - 1) ///< Occupancy mask of a completely filled row
+#define MAX_PLACEMENTS 256      ///< Maximum number of placements returned by iLogicGetPlacements()
+
+#if COLS > 16
+#error "The board only supports up to 16 columns, since each row is stored in a 16-bit mask"
+#endif
 
 /**
  * @name Initial coordinates
@@ -46,6 +57,47 @@
 #define DOWN_PRESSED 3  ///< Down-arrow key
 ///@}
 
+/**
+ * @brief State of a per-game pseudo random number generator (xoshiro128**).
+ * 
+ * Every game owns its generator, so that games are reproducible from their seed 
+ * & can be simulated in parallel without sharing any state.
+ */
+typedef struct rng
+{
+    uint32_t s[4]; ///< Internal state, must not be all zero
+} rng_t;
+
+/**
+ * @brief Generator for Tetromino types, handing out every type once per 7 Tetrominos.
+ * 
+ * Each bag of 7 types is shuffled with Fisher-Yates & appended to a ring buffer,
+ * so that upcoming types can be peeked at without consuming them.
+ * The bag has its own random number generator, so peeking never changes the rest of the game.
+ */
+typedef struct bag
+{
+    tetromino_type_t types[BAG_CAPACITY];   ///< Ring buffer of upcoming types
+    uint8_t head;                           ///< Index of the next type in the ring buffer
+    uint8_t count;                          ///< Number of upcoming types in the ring buffer
+    rng_t rng;                              ///< Random number generator for shuffling
+} bag_t;
+
+/**
+ * @brief Structure representing one rotation of a Tetromino type.
+ * 
+ * All shapes are precomputed in a constant table, see pxLogicGetShape().
+ * The coordinates are offsets relative to the top left corner of 
+ * a #FIGURE_SIZE x #FIGURE_SIZE area, x being the column & y being the row.
+ */
+typedef struct shape
+{
+    uint8_t count;                          ///< Number of squares, 0 for #NO_TYPE
+    coord_t squares[TETROMINO_SQUARES];     ///< Offsets of the squares
+    coord_t min;                            ///< Top left corner of the bounding box
+    coord_t max;                            ///< Bottom right corner of the bounding box
+} shape_t;
+
 /**
  * @brief Structure representing a Tetromino.
  */
@@ -54,15 +106,45 @@ typedef struct tetromino
     coord_t position;       ///< Position of top left square
     coord_t newPosition;    ///< New position to check
     tetromino_type_t type;  ///< Tetromino type
-    int rotation;           ///< Tetrominos rotation
+    int rotation;           ///< Tetrominos rotation, between 0 & #NUMBER_OF_ROTATIONS-1
     color_t color;          ///< Tetrominos color
+    const shape_t *shape;   ///< Tetrominos shape, pointing into the shape table
+} tetromino_t;
 
-    /// Array containing the Tetrominos shape.
-    color_t shape[FIGURE_SIZE][FIGURE_SIZE];
-    /// Array to check a potential shape
-    color_t newShape[FIGURE_SIZE][FIGURE_SIZE];
+/**
+ * @brief Structure representing a final position of a Tetromino, see iLogicGetPlacements().
+ */
+typedef struct placement
+{
+    coord_t position;       ///< Position of the Tetromino when it lands
+    int rotation;           ///< Rotation of the Tetromino, between 0 & #NUMBER_OF_ROTATIONS-1
+    const shape_t *shape;   ///< Shape of the Tetromino when it lands
+} placement_t;
 
-} tetromino_t;
+/**
+ * @brief Structure representing the board of landed Tetrominos.
+ * 
+ * Each row is stored as an occupancy mask, where bit n is set if column n is occupied,
+ * so that collision checks & full rows only need a few mask operations.
+ * The colors of the landed squares are kept in a separate plane, that is only read by the @ref gui "GUI".
+ * Row 0 is the bottom row of the board.
+ * 
+ * The column heights, row fill counts & the number of holes are caches,
+ * that are updated incrementally by vLogicAddToLanded() & usLogicRowFull(),
+ * so they never have to be computed by scanning the whole board.
+ * The same goes for the Zobrist hash, the XOR of a random key for every occupied square,
+ * so that identical boards can be recognized without comparing them.
+ */
+typedef struct board
+{
+    uint16_t rows[ROWS];        ///< Occupancy mask of each row
+    uint8_t colors[ROWS][COLS]; ///< @ref color_t "Color" of each square
+    uint8_t heights[COLS];      ///< Height of each column, i.e. index of its highest occupied row+1, 0 if empty
+    uint8_t rowFill[ROWS];      ///< Number of occupied squares in each row
+    uint16_t fullRows;          ///< Mask of the rows, that are full & not cleared yet, bit n for row n
+    uint8_t holes;              ///< Number of empty squares below the highest occupied square of their column
+    uint64_t hash;              ///< Zobrist hash of the occupied squares, 0 for an empty board
+} board_t;
 
 /**
  * @brief Structure for the score.
@@ -70,98 +152,202 @@ typedef struct tetromino
 typedef struct score
 {
     uint32_t score;     ///< The current score
-    uint8_t level;      ///< The current level
-    uint16_t rows;      ///< Number of rows cleared
+    uint16_t level;     ///< The current level
+    uint32_t rows;      ///< Number of rows cleared
     char *userName;     ///< The selected User-Name
 } score_t;
 
+/**
+ * @brief Seed a random number generator.
+ * 
+ * The state is expanded from @p seed with splitmix32, so that similar seeds lead to unrelated sequences.
+ * @param[out] rng ( @ref rng_t *): Generator to seed.
+ * @param[in] seed (uint32_t): The seed, e.g. the one sent to the opponent.
+ */
+void vLogicSeedRandom(rng_t *rng, uint32_t seed);
+
+/**
+ * @brief Get the next random number of @p rng.
+ * @param[inout] rng ( @ref rng_t *): The generator.
+ * @return (uint32_t): A uniformly distributed 32-bit number.
+ */
+uint32_t ulLogicRandom(rng_t *rng);
+
+/**
+ * @brief Mix @p x into a well distributed 64-bit key (splitmix64).
+ * 
+ * The Zobrist keys of the squares are derived from their index this way,
+ * it can also be used to derive keys for e.g. Tetromino types.
+ * @param[in] x (uint64_t): Value to mix.
+ * @return (uint64_t): The key.
+ */
+uint64_t ullLogicHashKey(uint64_t x);
+
+/**
+ * @brief Initialize an empty bag.
+ * @param[out] bag ( @ref bag_t *): Bag to initialize.
+ * @param[in] seed (uint32_t): Seed of the bag's random number generator.
+ */
+void vLogicInitBag(bag_t *bag, uint32_t seed);
+
+/**
+ * @brief Peek at an upcoming type of @p bag without consuming it.
+ * 
+ * New bags are shuffled until the requested type is available.
+ * @param[inout] bag ( @ref bag_t *): The bag.
+ * @param[in] depth (int): Which type to peek at, 0 is the next one, at most #BAG_MAX_PREVIEW.
+ * @return ( @ref tetromino_type_t): The type.
+ */
+tetromino_type_t eLogicBagPeek(bag_t *bag, int depth);
+
+/**
+ * @brief Take the next type out of @p bag.
+ * @param[inout] bag ( @ref bag_t *): The bag.
+ * @return ( @ref tetromino_type_t): The type.
+ */
+tetromino_type_t eLogicBagNext(bag_t *bag);
+
 /**
  * @brief Initialize a Tetromino.
  * 
- * -# Set the Tetromino's type by calling setTetrominoType().
+ * -# Unless in multiplayer mode, take the Tetromino's type out of the @p bag.
  * -# Set rotation
  * -# Set color
  * -# Init the position
- * -# Set the @ref tetromino_t::shape "shape array".
+ * -# Set the @ref tetromino_t::shape "shape" to the spawn variant of the rotation.
  * 
  * @param[out] tetromino ( @ref tetromino_t *): Tetromino to initialize.
- * @param[in] types ( @ref tetromino_type_t [][]): Array of possible types.
- * @param[in] index (int*): Index of the types-array. 
+ * @param[inout] bag ( @ref bag_t *): Bag of upcoming types. 
  * @param[in] playerMode ( @ref player_mode_t): Current player mode. 
+ * @param[inout] rng ( @ref rng_t *): Random number generator of the game.
  */
 void vLogicInitTetromino(   tetromino_t *tetromino, 
-                            tetromino_type_t types[], 
-                            int *index, 
-                            player_mode_t playerMode);
+                            bag_t *bag, 
+                            player_mode_t playerMode,
+                            rng_t *rng);
+
+/**
+ * @brief Get a shape from the precomputed shape table.
+ * 
+ * Some Tetrominos are shaped differently, when they are spawned,
+ * they keep this variant until they are rotated for the first time.
+ * @param[in] type ( @ref tetromino_type_t): Type of the Tetromino.
+ * @param[in] rotation (int): Rotation of the Tetromino, between 0 & #NUMBER_OF_ROTATIONS-1.
+ * @param[in] spawn (bool): Whether to get the spawn variant of the shape.
+ * @return (const @ref shape_t *): The shape.
+ */
+const shape_t *pxLogicGetShape(tetromino_type_t type, int rotation, bool spawn);
 
 /**
  * @brief Check if a move to a @p newPosition is possible.
  * 
- * Check for possible collisions on the side borders, 
- * the ground and with the landed tetrominos.
- * @param[in] newShape (const @ref color_t): New shape to check. 
+ * Check the shape's bounding box against the side borders & the ground,
+ * then check each square for collisions with the landed tetrominos.
+ * @param[in] newShape (const @ref shape_t *): New shape to check. 
  * @param[in] newPosition ( @ref coord_t): New position to check.
- * @param[in] landed (const @ref landed): Array of landed Tetrominos.
+ * @param[in] landed (const @ref board_t *): Board of landed Tetrominos.
  * @return (bool): whether a move to a @p newPosition is possible.
  */
-bool bLogicCheckMove(   const color_t newShape[FIGURE_SIZE][FIGURE_SIZE], 
-                        coord_t newPosition,
-                        const color_t landed[ROWS][COLS]);
+bool bLogicCheckMove(const shape_t *newShape, coord_t newPosition, const board_t *landed);
+
+/**
+ * @brief Get how many rows a shape can fall from @p position, until it hits the ground or the landed Tetrominos.
+ * 
+ * If every square is above the top of its column, this only needs a look-up of the column heights,
+ * otherwise the shape is moved down row by row with bLogicCheckMove().
+ * @param[in] shape (const @ref shape_t *): Shape to drop.
+ * @param[in] position ( @ref coord_t): Current position of the shape, which must not collide.
+ * @param[in] landed (const @ref board_t *): Board of landed Tetrominos.
+ * @return (int): Number of rows the shape can fall.
+ */
+int iLogicDropDistance(const shape_t *shape, coord_t position, const board_t *landed);
 
 /**
  * @brief Check if the game will be over if the new @p tetromino is created.
  * @param[in] tetromino (const @ref tetromino_t *): Tetromino to check.
- * @param[in] landed (const @ref color_t [][]): Array of landed Tetrominos.
+ * @param[in] landed (const @ref board_t *): Board of landed Tetrominos.
  * @return (bool): whether the game will be over.
  */
-bool bLogicCheckGameOver(const tetromino_t *tetromino, const color_t landed[ROWS][COLS]);
+bool bLogicCheckGameOver(const tetromino_t *tetromino, const board_t *landed);
 
 /**
  * @brief Update the x coordinate of @p tetromino.
  * 
  * If the @p pressedButton is #LEFT_PRESSED/#RIGHT_PRESSED, try to decrease/increase the position by 1.
  * @param[inout] tetromino ( @ref tetromino_t *): Tetromino object to increase x coordinate of. 
- * @param[in] landed (const @ref color_t [][]): Array of landed Tetrominos. 
+ * @param[in] landed (const @ref board_t *): Board of landed Tetrominos. 
  * @param[in] pressedButton (int): The button that was pressed. 
  */
-void vLogicUpdateXCoord(tetromino_t *tetromino, const color_t landed[ROWS][COLS], int pressedButton);
+void vLogicUpdateXCoord(tetromino_t *tetromino, const board_t *landed, int pressedButton);
 
 /**
  * @brief Update the y coordinate of @p tetromino.
  * @param[inout] tetromino ( @ref tetromino_t *): Tetromino object to increase y coordinate of. 
- * @param[in] landed (const @ref color_t [][]): Array of landed Tetrominos. 
+ * @param[in] landed (const @ref board_t *): Board of landed Tetrominos. 
  * @return (bool): true if the y coordinate could be increased.
  */
-bool bLogicUpdateYCoord(tetromino_t *tetromino, const color_t landed[ROWS][COLS]);
+bool bLogicUpdateYCoord(tetromino_t *tetromino, const board_t *landed);
 
 /**
  * @brief Rotate @p tetromino, if possible.
  * 
  * -# Increase/decrease @p tetromino's rotation counter, depending on @p rotationMode.
- * -# Set @p tetromino's @ref tetromino_t::newShape "new shape", by calling setTetrominoShape().
+ * -# Look up the new shape with pxLogicGetShape().
  * -# Check if that new shape is possible with bLogicCheckMove().
- * -# If it is, copy the new shape to @ref tetromino_t::shape "the old shape".
+ * -# If it is, set it as @p tetromino's @ref tetromino_t::shape "shape".
  * 
  * @param[inout] tetromino ( @ref tetromino_t *): Tetromino object to rotate. 
- * @param[in] landed (const @ref color_t [][]): Array of landed Tetrominos. 
+ * @param[in] landed (const @ref board_t *): Board of landed Tetrominos. 
  * @param[in] rotationMode ( @ref rotation_t): Rotation mode, either left or right. 
  */
-void vLogicRotate(tetromino_t *tetromino, const color_t landed[ROWS][COLS], rotation_t rotationMode);
+void vLogicRotate(tetromino_t *tetromino, const board_t *landed, rotation_t rotationMode);
 
 /**
- * @brief Add @p tetromino to the @p landed array.
+ * @brief Get all distinct final positions @p tetromino can reach from its current position.
+ * 
+ * The moves of vLogicUpdateXCoord(), vLogicRotate() & bLogicUpdateYCoord() are searched breadth-first,
+ * every position, rotation & shape variant is visited once, which is tracked in a bitset.
+ * A position is final, if the Tetromino cannot move down from it. 
+ * Final positions covering the same squares, e.g. the two horizontal rotations of an I, are only returned once.
+ * 
+ * No memory is allocated, the search only uses a few kilobytes of stack.
+ * @param[in] tetromino (const @ref tetromino_t *): Tetromino to place, at its current position.
+ * @param[in] landed (const @ref board_t *): Board of landed Tetrominos. 
+ * @param[in] rotationMode ( @ref rotation_t): Rotation mode, either left or right. 
+ * @param[out] placements ( @ref placement_t []): Array for the final positions.
+ * @param[in] maxPlacements (int): Size of @p placements, at most #MAX_PLACEMENTS are used.
+ * @return (int): Number of final positions stored in @p placements, 
+ * 0 if @p tetromino collides at its current position.
+ */
+int iLogicGetPlacements(const tetromino_t *tetromino, 
+                        const board_t *landed, 
+                        rotation_t rotationMode, 
+                        placement_t placements[], 
+                        int maxPlacements);
+
+/**
+ * @brief Add @p tetromino to the @p landed board.
+ * 
+ * Set the Tetromino's squares in the row masks & store its color in the color plane.
+ * The column heights, row fill counts, number of holes & the hash are updated for the 4 squares only,
+ * rows that become full are marked in @ref board_t::fullRows.
  * @param[in] tetromino (const @ref tetromino_t *): Tetromino to add 
- * @param[out] landed ( @ref color_t [][]): Array of landed Tetrominos. 
+ * @param[out] landed ( @ref board_t *): Board of landed Tetrominos. 
  */
-void vLogicAddToLanded(const tetromino_t *tetromino, color_t landed[ROWS][COLS]);
+void vLogicAddToLanded(const tetromino_t *tetromino, board_t *landed);
 
 /**
  * @brief Check how many rows are full and remove them.
- * @param[inout] landed ( @ref color_t [][]): Array of landed Tetrominos. 
+ * 
+ * The full rows were already marked by vLogicAddToLanded(), so nothing is done if there are none.
+ * Otherwise, the board is compacted in a single pass, that copies each remaining row straight to its final row,
+ * & the cached column heights & the number of holes are updated.
+ * The hash is only updated for the cleared rows & the rows that moved.
+ * @param[inout] landed ( @ref board_t *): Board of landed Tetrominos. 
  * @param[inout] score ( @ref score_t *): Score object to increase if rows are full. 
- * @return (bool): true if one or more rows are full. False otherwise.
+ * @return (uint16_t): Mask of the cleared rows before compacting, bit n for row n, 0 if no row was full.
  */
-bool vLogicRowFull(color_t landed[ROWS][COLS], score_t *score);
+uint16_t usLogicRowFull(board_t *landed, score_t *score);
 
 ///@}
 #endif //LOGIC_H
\ No newline at end of file
@@ -26,6 +26,7 @@
 #include "tetrisConfig.h"
 
 extern QueueHandle_t TetrominoQueue;
+extern QueueHandle_t SeedQueue;
 extern SemaphoreHandle_t NextTetrominoSignal;
 extern TaskHandle_t UDPControlTask;
 
@@ -37,8 +37,13 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
 #include <time.h>
 
+// Tools that only use the logic & engine modules (e.g. the simulator)
+// define TETRIS_HEADLESS & are built without FreeRTOS & SDL.
+#ifndef TETRIS_HEADLESS
 #include <SDL2/SDL_scancode.h>
 
 #include "FreeRTOS.h"
@@ -47,13 +52,15 @@
 #include "semphr.h"
 #include "queue.h"
 
-#include "TUM_Draw.h"
 #include "TUM_Font.h"
 #include "TUM_Event.h"
 #include "TUM_Sound.h"
-#include "TUM_Utils.h"
 #include "TUM_FreeRTOS_Utils.h"
 #include "TUM_Print.h"
+#endif // TETRIS_HEADLESS
+
+#include "TUM_Draw.h"
+#include "TUM_Utils.h"
 
 #include "enum.h"
 #include "EmulatorConfig.h"
@@ -81,6 +88,14 @@
 #define SQUARE_WIDTH 40 ///< Pixel width/height of one square
 #define NUMBER_OF_TETRIS_COLORS 6 ///< Number of colors
 #define BACKGROUND_COLOR ((unsigned int) 0x656565)  ///< Background color (can be any HEX color)
+#define GHOST_COLOR ((unsigned int) 0xB4B4B4)       ///< Outline color of the ghost piece (can be any HEX color)
+///@}
+
+/**
+ * @name AI configuration
+ * @{
+ */
+#define AI_WEIGHTS_FILE "../resources/ai_weights.cfg" ///< Weights of the AI, as written by tetris_tune (the default weights are used if it does not exist)
 ///@}
 
 /**
@@ -0,0 +1,81 @@
+/**
+ * @file threadPool.h
+ * 
+ * @authors Philipp Karg (philipp.karg@tum.de)
+ * 
+ * @brief Header file for threadPool.c.
+ * @date 16.10.2026
+ * @copyright Philipp Karg 2022
+ */
+
+/**
+ * @defgroup pool Thread Pool Module
+ * @ingroup tetris
+ * @brief Module that runs independent jobs on all CPU cores.
+ * 
+ * The pool consists of POSIX threads, that run outside of the FreeRTOS scheduler.
+ * A parallel for-loop splits its indices evenly between the workers.
+ * Workers that run out of indices steal half of the remaining indices of another worker,
+ * so that jobs of different lengths, e.g. whole games, are balanced.
+ * 
+ * @authors Philipp Karg (philipp.karg@tum.de)
+ * @date 16.10.2026
+ * @copyright Philipp Karg 2022
+ * @{
+ */
+
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include "tetrisConfig.h"
+
+/**
+ * @brief Job that is run for every index of vThreadPoolParallelFor().
+ * @param[in] index (int): Index to run the job for.
+ * @param[in] worker (int): Index of the worker running the job, between 0 & the number of workers-1.
+ * @param[in] args (void*): Additional arguments.
+ */
+typedef void (*pool_job_t)(int index, int worker, void *args);
+
+/**
+ * @brief Opaque structure representing a thread pool.
+ */
+typedef struct thread_pool thread_pool_t;
+
+/**
+ * @brief Create a thread pool.
+ * 
+ * The calling thread is used as worker 0, so @p workers-1 threads are created.
+ * All signals are blocked in these threads, so that they do not receive the signals
+ * of the FreeRTOS POSIX port.
+ * @param[in] workers (int): Number of workers, 0 to use one per online CPU core.
+ * @return ( @ref thread_pool_t *): The thread pool, NULL upon failure.
+ */
+thread_pool_t *pxThreadPoolCreate(int workers);
+
+/**
+ * @brief Stop all threads of @p pool & free it.
+ * @param[in] pool ( @ref thread_pool_t *): Thread pool to delete.
+ */
+void vThreadPoolDelete(thread_pool_t *pool);
+
+/**
+ * @brief Get the number of workers of @p pool.
+ * @param[in] pool (const @ref thread_pool_t *): The thread pool.
+ * @return (int): Number of workers, including the calling thread.
+ */
+int iThreadPoolGetWorkers(const thread_pool_t *pool);
+
+/**
+ * @brief Run @p job for every index from 0 to @p count-1 on all workers & wait until they are done.
+ * 
+ * Must only be called from one thread at a time.
+ * @param[in] pool ( @ref thread_pool_t *): The thread pool.
+ * @param[in] count (int): Number of indices.
+ * @param[in] job ( @ref pool_job_t): Job to run for each index.
+ * @param[in] args (void*): Additional arguments passed to @p job.
+ */
+void vThreadPoolParallelFor(thread_pool_t *pool, int count, pool_job_t job, void *args);
+
+///@}
+#endif // THREAD_POOL_H
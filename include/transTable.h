@@ -0,0 +1,77 @@
+/**
+ * @file transTable.h
+ * 
+ * @authors Philipp Karg (philipp.karg@tum.de)
+ * 
+ * @brief Header file for transTable.c.
+ * @date 16.10.2026
+ * @copyright Philipp Karg 2022
+ */
+
+/**
+ * @defgroup table Transposition Table Module
+ * @ingroup tetris
+ * @brief Module that caches results of a search, keyed by a 64-bit hash.
+ * 
+ * The table has a fixed number of entries & every key is mapped to exactly one of them,
+ * a new result always replaces the old one.
+ * It can be shared by all workers of a @ref pool "Thread Pool" without any locks:
+ * each entry stores the XOR of the key & the data next to the data,
+ * so that an entry, that was torn by two workers writing it at the same time, never matches a key.
+ * 
+ * @authors Philipp Karg (philipp.karg@tum.de)
+ * @date 16.10.2026
+ * @copyright Philipp Karg 2022
+ * @{
+ */
+
+#ifndef TRANS_TABLE_H
+#define TRANS_TABLE_H
+
+#include "tetrisConfig.h"
+
+/**
+ * @brief Opaque structure representing a transposition table.
+ */
+typedef struct trans_table trans_table_t;
+
+/**
+ * @brief Create an empty transposition table.
+ * @param[in] bits (int): The table has 2^@p bits entries of 16 bytes each.
+ * @return ( @ref trans_table_t *): The table, NULL upon failure.
+ */
+trans_table_t *pxTransTableCreate(int bits);
+
+/**
+ * @brief Free @p table.
+ * @param[in] table ( @ref trans_table_t *): Table to delete.
+ */
+void vTransTableDelete(trans_table_t *table);
+
+/**
+ * @brief Remove all entries from @p table, e.g. if the results depend on something, that changed.
+ * 
+ * Must not be called while other threads use the table.
+ * @param[in] table ( @ref trans_table_t *): The table.
+ */
+void vTransTableClear(trans_table_t *table);
+
+/**
+ * @brief Look up the data stored for @p key.
+ * @param[in] table (const @ref trans_table_t *): The table.
+ * @param[in] key (uint64_t): The key.
+ * @param[out] data (uint64_t *): The data, if it was found.
+ * @return (bool): Whether data was stored for @p key.
+ */
+bool bTransTableLookup(const trans_table_t *table, uint64_t key, uint64_t *data);
+
+/**
+ * @brief Store @p data for @p key, replacing the entry @p key is mapped to.
+ * @param[in] table ( @ref trans_table_t *): The table.
+ * @param[in] key (uint64_t): The key.
+ * @param[in] data (uint64_t): The data.
+ */
+void vTransTableStore(trans_table_t *table, uint64_t key, uint64_t data);
+
+///@}
+#endif // TRANS_TABLE_H
@@ -48,6 +48,20 @@
 #define GREEN_PORTION(COLOUR) (COLOUR & 0x00FF00) >> ONE_BYTE
 #define BLUE_PORTION(COLOUR) (COLOUR & 0x0000FF)
 #define ZERO_ALPHA 0
+#define ATLAS_PADDING 1
+#define QUAD_VERTICES 4
+#define QUAD_INDICES 6
+#define GLYPH_ATLAS_SIZE 512
+#define GLYPH_FIRST ' '
+#define GLYPH_LAST '~'
+#define GLYPH_COUNT (GLYPH_LAST - GLYPH_FIRST + 1)
+#define TEXT_SIZE_CACHE_SIZE 256
+#define TEXT_SIZE_MAX_LEN 64
+#define JOB_ARENA_CHUNK_SIZE (64 * 1024)
+#define JOB_ARENA_ALIGN 16
+#define DAMAGE_PADDING 1
+#define JOB_ARENA_ROUND(SIZE)                                                  \
+    (((SIZE) + JOB_ARENA_ALIGN - 1) & ~((size_t)JOB_ARENA_ALIGN - 1))
 
 typedef enum {
     DRAW_NONE = 0,
@@ -64,8 +78,12 @@ typedef enum {
     DRAW_IMAGE,
     DRAW_LOADED_IMAGE,
     DRAW_LOADED_IMAGE_CROP,
+    DRAW_IMAGE_BATCH,
     DRAW_SCALED_IMAGE,
     DRAW_ARROW,
+    DRAW_LAYER_BEGIN,
+    DRAW_LAYER_END,
+    DRAW_LAYER,
 } draw_job_type_t;
 
 typedef struct loaded_image {
@@ -77,6 +95,8 @@ typedef struct loaded_image {
     int w;
     int h;
     float scale;
+    SDL_Rect *regions;
+    unsigned regions_count;
     //TODO make this atomic
     unsigned int ref_count;
     unsigned char pending_free;
@@ -84,6 +104,41 @@ typedef struct loaded_image {
     struct loaded_image *next;
 } loaded_image_t;
 
+typedef struct layer {
+    SDL_Texture *tex;
+    int w;
+    int h;
+    unsigned char valid; // Accessed with __atomic builtins
+    unsigned char redrawn;
+    unsigned int ref_count; // Accessed with __atomic builtins
+    unsigned char pending_free;
+
+    struct layer *next;
+} layer_t;
+
+typedef struct glyph {
+    SDL_Rect region;
+    int min_x;
+    int advance;
+    unsigned char cached;
+} glyph_t;
+
+typedef struct glyph_set {
+    unsigned long font_key;
+    glyph_t glyphs[GLYPH_COUNT];
+
+    struct glyph_set *next;
+} glyph_set_t;
+
+typedef struct text_size {
+    unsigned long font_key;
+    unsigned long hash;
+    char str[TEXT_SIZE_MAX_LEN];
+    int w;
+    int h;
+    unsigned char valid;
+} text_size_t;
+
 typedef struct loaded_image_crop {
     loaded_image_t *image;
     int x;
@@ -194,6 +249,13 @@ typedef struct loaded_image_data {
     signed short y;
 } loaded_image_data_t;
 
+typedef struct image_batch_data {
+    loaded_image_t *atlas;
+    unsigned *regions;
+    coord_t *positions;
+    unsigned count;
+} image_batch_data_t;
+
 typedef struct scaled_image_data {
     image_data_t image;
     float scale;
@@ -204,9 +266,16 @@ typedef struct text_data {
     signed short x;
     signed short y;
     unsigned int colour;
-    TTF_Font *font;
+    font_handle_t font;
+    unsigned long font_key;
 } text_data_t;
 
+typedef struct layer_data {
+    layer_t *layer;
+    signed short x;
+    signed short y;
+} layer_data_t;
+
 typedef struct arrow_data {
     signed short x1;
     signed short y1;
@@ -229,19 +298,70 @@ union data_u {
     image_data_t image;
     loaded_image_data_t loaded_image;
     loaded_image_crop_t loaded_image_crop;
+    image_batch_data_t image_batch;
     scaled_image_data_t scaled_image;
     text_data_t text;
     arrow_data_t arrow;
+    layer_data_t layer;
 };
 
 typedef struct draw_job {
     draw_job_type_t type;
-    union data_u *data;
+    union data_u data;
+    SDL_Rect bbox;
 
     struct draw_job *next;
 } draw_job_t;
 
-draw_job_t job_list_head = { 0 };
+// Jobs & their buffers are bump allocated, the arena is reset once drawn
+typedef struct job_arena_chunk {
+    size_t used;
+    size_t size;
+    struct job_arena_chunk *next;
+} job_arena_chunk_t;
+
+struct job_arena {
+    job_arena_chunk_t *first;
+    job_arena_chunk_t *cur;
+};
+
+typedef struct draw_list {
+    draw_job_t head;
+    draw_job_t *tail;
+    struct job_arena arena;
+} draw_list_t;
+
+/*
+ * Jobs are recorded into one list by the single drawing task, so appending
+ * needs no lock. tumDrawSubmitFrame() swaps it with the ready list &
+ * tumDrawUpdateScreen() swaps the ready list with the list it draws. Only the
+ * swaps are done while holding the lock, which tumDrawUpdateScreen() only
+ * tries to take, as it must not block on a task it preempted. The last drawn
+ * list is kept to find the regions that changed in the next frame.
+ */
+pthread_mutex_t draw_lists_lock = PTHREAD_MUTEX_INITIALIZER;
+draw_list_t draw_lists[4] = {
+    { .tail = &draw_lists[0].head },
+    { .tail = &draw_lists[1].head },
+    { .tail = &draw_lists[2].head },
+    { .tail = &draw_lists[3].head },
+};
+draw_list_t *record_list = &draw_lists[0];
+draw_list_t *ready_list = &draw_lists[1];
+draw_list_t *render_list = &draw_lists[2];
+draw_list_t *previous_list = &draw_lists[3];
+unsigned char frame_ready = 0;
+
+// Copy of the screen, only the damaged region of it is drawn again
+struct screen {
+    SDL_Texture *tex;
+    SDL_Rect damage;
+    int x_offset;
+    int y_offset;
+    unsigned char full; // Accessed with __atomic builtins
+};
+
+struct screen screen = { .full = 1 };
 
 struct global_offsets {
     int x;
@@ -256,6 +376,33 @@ struct global_offsets global_offset = {
 pthread_mutex_t loaded_images_lock = PTHREAD_MUTEX_INITIALIZER;
 loaded_image_t loaded_images_list = { 0 };
 
+pthread_mutex_t layers_lock = PTHREAD_MUTEX_INITIALIZER;
+layer_t layers_list = { 0 };
+
+// Only used by the drawing thread, so no lock is needed
+struct glyph_atlas {
+    SDL_Texture *tex;
+    int x;
+    int y;
+    int row_h;
+    glyph_set_t *sets;
+};
+
+struct glyph_atlas glyph_atlas = { 0 };
+
+// Sizes of recently measured strings, looked up by their hash
+pthread_mutex_t text_sizes_lock = PTHREAD_MUTEX_INITIALIZER;
+text_size_t text_sizes[TEXT_SIZE_CACHE_SIZE] = { 0 };
+
+// Quads of the current batch, only used by the drawing thread
+struct quad_buffer {
+    SDL_Vertex *vertices;
+    int *indices;
+    unsigned capacity;
+};
+
+struct quad_buffer quad_buffer = { 0 };
+
 const int screen_height = SCREEN_HEIGHT;
 const int screen_width = SCREEN_WIDTH;
 
@@ -263,6 +410,9 @@ SDL_Window *window = NULL;
 SDL_Renderer *renderer = NULL;
 SDL_GLContext context = NULL;
 
+// Target of the software renderer if no window is used
+SDL_Surface *offscreen = NULL;
+
 char *error_message = NULL;
 
 static uint32_t SwapBytes(unsigned int x)
@@ -290,33 +440,103 @@ void setErrorMessage(char *msg)
     PRINT_ERROR("[SDL Error] %s\n" #msg, (char *)SDL_GetError(),           \
                 ##__VA_ARGS__)
 
+static void *_jobAlloc(struct job_arena *arena, size_t size)
+{
+    job_arena_chunk_t *chunk = arena->cur;
+    size_t header = JOB_ARENA_ROUND(sizeof(job_arena_chunk_t));
+
+    size = JOB_ARENA_ROUND(size);
+
+    // Chunks after the current one are left over from larger frames
+    while (chunk && chunk->used + size > chunk->size) {
+        chunk = chunk->next;
+    }
+
+    if (chunk == NULL) {
+        size_t chunk_size = size > JOB_ARENA_CHUNK_SIZE ? size :
+                            JOB_ARENA_CHUNK_SIZE;
+
+        chunk = malloc(header + chunk_size);
+        if (chunk == NULL) {
+            return NULL;
+        }
+        chunk->used = 0;
+        chunk->size = chunk_size;
+        chunk->next = NULL;
+
+        if (arena->first == NULL) {
+            arena->first = chunk;
+        }
+        else {
+            job_arena_chunk_t *iterator = arena->first;
+
+            for (; iterator->next; iterator = iterator->next)
+                ;
+
+            iterator->next = chunk;
+        }
+    }
+
+    arena->cur = chunk;
+
+    void *ret = (char *)chunk + header + chunk->used;
+    chunk->used += size;
+
+    return ret;
+}
+
+static void *jobAlloc(size_t size)
+{
+    return _jobAlloc(&record_list->arena, size);
+}
+
+static void resetDrawList(draw_list_t *list)
+{
+    job_arena_chunk_t *chunk = list->arena.first;
+
+    for (; chunk; chunk = chunk->next) {
+        chunk->used = 0;
+    }
+
+    list->arena.cur = list->arena.first;
+    list->head.next = NULL;
+    list->tail = &list->head;
+}
+
+static char *jobStrdup(char *str)
+{
+    char *ret = jobAlloc(strlen(str) + 1);
+
+    if (ret) {
+        strcpy(ret, str);
+    }
+
+    return ret;
+}
+
 static draw_job_t *pushDrawJob(void)
 {
-    draw_job_t *iterator;
-    draw_job_t *job = calloc(1, sizeof(draw_job_t));
+    draw_job_t *job = _jobAlloc(&record_list->arena, sizeof(draw_job_t));
     if (job == NULL) {
         return NULL;
     }
 
-    for (iterator = &job_list_head; iterator->next;
-         iterator = iterator->next)
-        ;
+    memset(job, 0, sizeof(draw_job_t));
 
-    iterator->next = job;
+    record_list->tail->next = job;
+    record_list->tail = job;
 
     return job;
 }
 
-static draw_job_t *popDrawJob(void)
+static draw_job_t *popDrawJob(draw_list_t *list)
 {
-    draw_job_t *ret = job_list_head.next;
+    draw_job_t *ret = list->head.next;
 
     if (ret) {
-        if (ret->next) {
-            job_list_head.next = ret->next;
-        }
-        else {
-            job_list_head.next = NULL;
+        list->head.next = ret->next;
+        if (list->tail == ret) {
+            list->tail = &list->head;
         }
     }
 
@@ -328,7 +548,15 @@ static int _clearDisplay(unsigned int colour)
     SDL_SetRenderDrawColor(renderer, (colour >> 16) & 0xFF,
                            (colour >> 8) & 0xFF, colour & 0xFF,
                            ALPHA_SOLID);
-    SDL_RenderClear(renderer);
+
+    // Clearing ignores the clip rectangle of the damaged region
+    if (SDL_RenderIsClipEnabled(renderer)) {
+        SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
+        SDL_RenderFillRect(renderer, NULL);
+    }
+    else {
+        SDL_RenderClear(renderer);
+    }
 
     return 0;
 }
@@ -648,8 +876,11 @@ static int freeLoadedImage(loaded_image_t **img)
         }
 
         SDL_FreeSurface(delete->surf);
-        SDL_RWclose(delete->ops);
+        if (delete->ops) {
+            SDL_RWclose(delete->ops);
+        }
         SDL_DestroyTexture(delete->tex);
+        free(delete->regions);
         free(delete->filename);
         free(delete);
         *img = (loaded_image_t *)NULL;
@@ -672,6 +903,97 @@ static void vPutLoadedImage(image_handle_t img)
     }
 }
 
+static int freeLayer(layer_t **layer)
+{
+    int ret = -1;
+
+    pthread_mutex_lock(&layers_lock);
+    layer_t *iterator = &layers_list;
+
+    for (; iterator->next; iterator = iterator->next)
+        if (iterator->next == *layer) {
+            break;
+        }
+
+    if (iterator->next == *layer) {
+        layer_t *delete = iterator->next;
+        iterator->next = delete->next;
+
+        if (delete->tex) {
+            SDL_DestroyTexture(delete->tex);
+        }
+        free(delete);
+        *layer = (layer_t *)NULL;
+
+        ret = 0;
+    }
+    pthread_mutex_unlock(&layers_lock);
+
+    return ret;
+}
+
+static void vPutLayer(layer_t *layer)
+{
+    if (!__atomic_sub_fetch(&layer->ref_count, 1, __ATOMIC_ACQ_REL) &&
+        __atomic_load_n(&layer->pending_free, __ATOMIC_ACQUIRE)) {
+        freeLayer(&layer);
+    }
+}
+
+static void vSetLayerValid(layer_t *layer, unsigned char valid)
+{
+    __atomic_store_n(&layer->valid, valid, __ATOMIC_RELEASE);
+}
+
+static int _beginLayer(layer_t *layer)
+{
+    if (layer->tex == NULL) {
+        layer->tex = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888,
+                                       SDL_TEXTUREACCESS_TARGET, layer->w,
+                                       layer->h);
+        if (layer->tex == NULL) {
+            PRINT_SDL_ERROR("Failed to create layer texture");
+            vSetLayerValid(layer, 0);
+            return -1;
+        }
+        SDL_SetTextureBlendMode(layer->tex, SDL_BLENDMODE_BLEND);
+    }
+
+    if (SDL_SetRenderTarget(renderer, layer->tex)) {
+        PRINT_SDL_ERROR("Failed to set layer as render target");
+        vSetLayerValid(layer, 0);
+        return -1;
+    }
+
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, ZERO_ALPHA);
+    SDL_RenderClear(renderer);
+
+    return 0;
+}
+
+static int _setScreenTarget(void)
+{
+    if (SDL_SetRenderTarget(renderer, screen.tex)) {
+        return -1;
+    }
+
+    if (screen.tex) {
+        return SDL_RenderSetClipRect(renderer, &screen.damage);
+    }
+
+    return 0;
+}
+
+static int _drawLayer(layer_t *layer, signed short x, signed short y)
+{
+    if (layer->tex == NULL) {
+        return 0;
+    }
+
+    return _renderScaledImage(layer->tex, renderer, x, y, layer->w,
+                              layer->h);
+}
+
 int xDrawLoadedImageCropped(loaded_image_t *img, SDL_Renderer *ren,
                             signed short x, signed short y, signed short c_x,
                             signed short c_y, signed short c_w,
@@ -687,6 +1009,123 @@ int xDrawLoadedImage(loaded_image_t *img, SDL_Renderer *ren, signed short x,
                               img->h * img->scale);
 }
 
+static int _reserveQuads(unsigned count)
+{
+    if (count <= quad_buffer.capacity) {
+        return 0;
+    }
+
+    SDL_Vertex *vertices = realloc(quad_buffer.vertices,
+                                   count * QUAD_VERTICES * sizeof(SDL_Vertex));
+    if (vertices == NULL) {
+        return -1;
+    }
+    quad_buffer.vertices = vertices;
+
+    int *indices =
+        realloc(quad_buffer.indices, count * QUAD_INDICES * sizeof(int));
+    if (indices == NULL) {
+        return -1;
+    }
+    quad_buffer.indices = indices;
+    quad_buffer.capacity = count;
+
+    return 0;
+}
+
+static void _setQuad(unsigned index, SDL_Rect *src, int tex_w, int tex_h,
+                     float x, float y, float w, float h, SDL_Color colour)
+{
+    float u0 = (float)src->x / tex_w;
+    float v0 = (float)src->y / tex_h;
+    float u1 = (float)(src->x + src->w) / tex_w;
+    float v1 = (float)(src->y + src->h) / tex_h;
+
+    SDL_Vertex *quad = &quad_buffer.vertices[index * QUAD_VERTICES];
+    quad[0] = (SDL_Vertex){ { x, y }, colour, { u0, v0 } };
+    quad[1] = (SDL_Vertex){ { x + w, y }, colour, { u1, v0 } };
+    quad[2] = (SDL_Vertex){ { x + w, y + h }, colour, { u1, v1 } };
+    quad[3] = (SDL_Vertex){ { x, y + h }, colour, { u0, v1 } };
+
+    int *quad_indices = &quad_buffer.indices[index * QUAD_INDICES];
+    int first = index * QUAD_VERTICES;
+    quad_indices[0] = first;
+    quad_indices[1] = first + 1;
+    quad_indices[2] = first + 2;
+    quad_indices[3] = first;
+    quad_indices[4] = first + 2;
+    quad_indices[5] = first + 3;
+}
+
+static int _renderQuads(SDL_Texture *tex, int tex_w, int tex_h,
+                        unsigned count)
+{
+    if (!count) {
+        return 0;
+    }
+
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+    (void)tex_w;
+    (void)tex_h;
+    return SDL_RenderGeometry(renderer, tex, quad_buffer.vertices,
+                              count * QUAD_VERTICES, quad_buffer.indices,
+                              count * QUAD_INDICES);
+#else
+    // Without geometry rendering, the quads are still drawn from one texture
+    int ret = 0;
+    unsigned i;
+
+    for (i = 0; i < count; i++) {
+        SDL_Vertex *quad = &quad_buffer.vertices[i * QUAD_VERTICES];
+        SDL_Rect src = { quad[0].tex_coord.x * tex_w,
+                         quad[0].tex_coord.y * tex_h,
+                         (quad[2].tex_coord.x - quad[0].tex_coord.x) *
+                         tex_w,
+                         (quad[2].tex_coord.y - quad[0].tex_coord.y) *
+                         tex_h
+                       };
+        SDL_Rect dst = { quad[0].position.x, quad[0].position.y,
+                         quad[2].position.x - quad[0].position.x,
+                         quad[2].position.y - quad[0].position.y
+                       };
+        SDL_SetTextureColorMod(tex, quad[0].color.r, quad[0].color.g,
+                               quad[0].color.b);
+        if (SDL_RenderCopy(renderer, tex, &src, &dst)) {
+            ret = -1;
+            break;
+        }
+    }
+    SDL_SetTextureColorMod(tex, MAX_8_BIT, MAX_8_BIT, MAX_8_BIT);
+
+    return ret;
+#endif
+}
+
+static int _drawImageBatch(loaded_image_t *atlas, unsigned *regions,
+                           coord_t *positions, unsigned count, int x_offset,
+                           int y_offset)
+{
+    SDL_Color white = { MAX_8_BIT, MAX_8_BIT, MAX_8_BIT, ALPHA_SOLID };
+    unsigned i, j;
+
+    if (_reserveQuads(count)) {
+        return -1;
+    }
+
+    for (i = 0, j = 0; i < count; i++) {
+        if (regions[i] >= atlas->regions_count) {
+            continue;
+        }
+
+        SDL_Rect *src = &atlas->regions[regions[i]];
+        _setQuad(j++, src, atlas->w, atlas->h, positions[i].x + x_offset,
+                 positions[i].y + y_offset, src->w * atlas->scale,
+                 src->h * atlas->scale, white);
+    }
+
+    return _renderQuads(atlas->tex, atlas->w, atlas->h, j);
+}
+
 static int _drawScaledImage(SDL_Texture *tex, SDL_Renderer *ren, signed short x,
                             signed short y, float scale)
 {
@@ -711,96 +1150,343 @@ static int _drawImage(SDL_Texture *tex, SDL_Renderer *ren, signed short x,
     return _drawScaledImage(tex, ren, x, y, 1);
 }
 
-static int _drawText(char *string, signed short x, signed short y,
-                     unsigned int colour, TTF_Font *font)
+static unsigned long _hashString(char *str, unsigned long seed)
 {
-    SDL_Color color = { RED_PORTION(colour), GREEN_PORTION(colour),
-                        BLUE_PORTION(colour), ZERO_ALPHA
-                      };
-    SDL_Surface *surface = TTF_RenderText_Solid(font, string, color);
-    tumFontPutFont(font);
-    SDL_Texture *texture = SDL_CreateTextureFromSurface(renderer, surface);
-    SDL_Rect dst = { 0 };
-    SDL_QueryTexture(texture, NULL, NULL, &dst.w, &dst.h);
-    dst.x = x;
-    dst.y = y;
-    SDL_RenderCopy(renderer, texture, NULL, &dst);
-    SDL_DestroyTexture(texture);
-    SDL_FreeSurface(surface);
+    unsigned long hash = seed;
 
-    return 0;
+    for (; str && *str; str++) {
+        hash = hash * 33 + (unsigned char)*str;
+    }
+
+    return hash;
 }
 
-static int _getTextSize(char *string, int *width, int *height)
+static void _resetGlyphAtlas(void)
 {
-    SDL_Color color = { 0 };
-    TTF_Font *font = tumFontGetCurFont();
-    SDL_Surface *surface = TTF_RenderText_Solid(font, string, color);
-    tumFontPutFont(font);
-    if (surface == NULL) {
-        goto err_surface;
+    glyph_set_t *set;
+
+    for (set = glyph_atlas.sets; set; set = set->next) {
+        memset(set->glyphs, 0, sizeof(set->glyphs));
     }
 
-    SDL_Texture *texture = SDL_CreateTextureFromSurface(renderer, surface);
-    if (texture == NULL) {
-        goto err_texture;
+    glyph_atlas.x = 0;
+    glyph_atlas.y = 0;
+    glyph_atlas.row_h = 0;
+}
+
+static void _freeGlyphAtlas(void)
+{
+    glyph_set_t *set = glyph_atlas.sets;
+
+    while (set) {
+        glyph_set_t *next = set->next;
+        free(set);
+        set = next;
     }
+    glyph_atlas.sets = NULL;
 
-    if (SDL_QueryTexture(texture, NULL, NULL, width, height)) {
-        goto err_query;
+    if (glyph_atlas.tex) {
+        SDL_DestroyTexture(glyph_atlas.tex);
+        glyph_atlas.tex = NULL;
     }
 
-    SDL_DestroyTexture(texture);
-    SDL_FreeSurface(surface);
+    _resetGlyphAtlas();
+}
 
-    return 0;
+static glyph_set_t *_getGlyphSet(unsigned long font_key)
+{
+    glyph_set_t *set;
 
-err_query:
-    SDL_DestroyTexture(texture);
-err_texture:
-    SDL_FreeSurface(surface);
-err_surface:
-    return -1;
+    for (set = glyph_atlas.sets; set; set = set->next)
+        if (set->font_key == font_key) {
+            return set;
+        }
+
+    set = calloc(1, sizeof(glyph_set_t));
+    if (set == NULL) {
+        return NULL;
+    }
+
+    set->font_key = font_key;
+    set->next = glyph_atlas.sets;
+    glyph_atlas.sets = set;
+
+    return set;
 }
 
-static int _drawArrow(signed short x1, signed short y1, signed short x2,
-                      signed short y2, signed short head_length,
-                      unsigned char thickness, unsigned int colour)
+/* Returns 1 if the atlas is full */
+static int _cacheGlyph(glyph_t *glyph, TTF_Font *font, char c)
 {
-    // Line vector
-    unsigned short dx = x2 - x1;
-    unsigned short dy = y2 - y1;
+    SDL_Color white = { MAX_8_BIT, MAX_8_BIT, MAX_8_BIT, ALPHA_SOLID };
+    int min_x, max_x, min_y, max_y;
 
-    // Normalize
-    float length = sqrt(dx * dx + dy * dy);
-    signed short unit_dx = (signed short)(dx / length);
-    signed short unit_dy = (signed short)(dy / length);
+    if (TTF_GlyphMetrics(font, c, &min_x, &max_x, &min_y, &max_y,
+                         &glyph->advance)) {
+        return -1;
+    }
 
-    signed short head_x1 =
-        roundf(x2 - unit_dx * head_length - unit_dy * head_length);
-    signed short head_y1 =
-        roundf(y2 - unit_dy * head_length + unit_dx * head_length);
+    // Glyphs reaching left of the pen are rendered shifted to the right
+    glyph->min_x = min_x < 0 ? min_x : 0;
+    glyph->region = (SDL_Rect){ 0 };
 
-    signed short head_x2 =
-        roundf(x2 - unit_dx * head_length + unit_dy * head_length);
-    signed short head_y2 =
-        roundf(y2 - unit_dy * head_length - unit_dx * head_length);
+    if (max_x <= min_x) {
+        glyph->cached = 1;
+        return 0;
+    }
 
-    if (thickLineColor(renderer, x1, y1, x2, y2, thickness,
-                       SwapBytes((colour << ONE_BYTE) | ALPHA_SOLID))) {
+    SDL_Surface *glyph_surface = TTF_RenderGlyph_Blended(font, c, white);
+    if (glyph_surface == NULL) {
         return -1;
     }
-    if (thickLineColor(renderer, head_x1, head_y1, x2, y2, thickness,
-                       SwapBytes((colour << ONE_BYTE) | ALPHA_SOLID))) {
+
+    SDL_Surface *surface =
+        SDL_ConvertSurfaceFormat(glyph_surface, SDL_PIXELFORMAT_RGBA32, 0);
+    SDL_FreeSurface(glyph_surface);
+    if (surface == NULL) {
         return -1;
     }
-    if (thickLineColor(renderer, head_x2, head_y2, x2, y2, thickness,
-                       SwapBytes((colour << ONE_BYTE) | ALPHA_SOLID))) {
+
+    if (glyph_atlas.x + surface->w > GLYPH_ATLAS_SIZE) {
+        glyph_atlas.x = 0;
+        glyph_atlas.y += glyph_atlas.row_h + ATLAS_PADDING;
+        glyph_atlas.row_h = 0;
+    }
+
+    if (glyph_atlas.y + surface->h > GLYPH_ATLAS_SIZE) {
+        SDL_FreeSurface(surface);
+        return 1;
+    }
+
+    glyph->region = (SDL_Rect){ glyph_atlas.x, glyph_atlas.y, surface->w,
+                                surface->h
+                              };
+
+    if (SDL_UpdateTexture(glyph_atlas.tex, &glyph->region, surface->pixels,
+                          surface->pitch)) {
+        SDL_FreeSurface(surface);
         return -1;
     }
 
-    return 0;
-}
+    glyph_atlas.x += surface->w + ATLAS_PADDING;
+    if (surface->h > glyph_atlas.row_h) {
+        glyph_atlas.row_h = surface->h;
+    }
+    glyph->cached = 1;
+
+    SDL_FreeSurface(surface);
+
+    return 0;
+}
+
+static int _isGlyphString(char *string)
+{
+    for (; *string; string++)
+        if (*string < GLYPH_FIRST || *string > GLYPH_LAST) {
+            return 0;
+        }
+
+    return 1;
+}
+
+static int _drawGlyphs(char *string, signed short x, signed short y,
+                       SDL_Color colour, TTF_Font *font,
+                       unsigned long font_key)
+{
+    size_t len = strlen(string);
+    size_t i;
+    unsigned j;
+    int attempt, ret;
+
+    if (!_isGlyphString(string)) {
+        return -1;
+    }
+
+    if (glyph_atlas.tex == NULL) {
+        glyph_atlas.tex = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA32,
+                                            SDL_TEXTUREACCESS_STATIC,
+                                            GLYPH_ATLAS_SIZE,
+                                            GLYPH_ATLAS_SIZE);
+        if (glyph_atlas.tex == NULL) {
+            return -1;
+        }
+        SDL_SetTextureBlendMode(glyph_atlas.tex, SDL_BLENDMODE_BLEND);
+    }
+
+    glyph_set_t *set = _getGlyphSet(font_key);
+    if (set == NULL) {
+        return -1;
+    }
+
+    if (_reserveQuads(len)) {
+        return -1;
+    }
+
+    // A full atlas is emptied once & the string is laid out again
+    for (attempt = 0; attempt < 2; attempt++) {
+        int pen = x;
+
+        for (i = 0, j = 0, ret = 0; i < len; i++) {
+            glyph_t *glyph = &set->glyphs[string[i] - GLYPH_FIRST];
+
+            if (!glyph->cached) {
+                ret = _cacheGlyph(glyph, font, string[i]);
+                if (ret) {
+                    break;
+                }
+            }
+
+            if (glyph->region.w) {
+                _setQuad(j++, &glyph->region, GLYPH_ATLAS_SIZE,
+                         GLYPH_ATLAS_SIZE, pen + glyph->min_x, y,
+                         glyph->region.w, glyph->region.h, colour);
+            }
+            pen += glyph->advance;
+        }
+
+        if (ret <= 0) {
+            break;
+        }
+        _resetGlyphAtlas();
+    }
+
+    if (ret) {
+        return -1;
+    }
+
+    return _renderQuads(glyph_atlas.tex, GLYPH_ATLAS_SIZE, GLYPH_ATLAS_SIZE,
+                        j);
+}
+
+static int _drawText(char *string, signed short x, signed short y,
+                     unsigned int colour, TTF_Font *font,
+                     unsigned long font_key)
+{
+    SDL_Color glyph_colour = { RED_PORTION(colour), GREEN_PORTION(colour),
+                               BLUE_PORTION(colour), ALPHA_SOLID
+                             };
+
+    if (_drawGlyphs(string, x, y, glyph_colour, font, font_key) == 0) {
+        return 0;
+    }
+
+    // Strings that can't be drawn from the glyph atlas are rendered as a whole
+    SDL_Color color = { RED_PORTION(colour), GREEN_PORTION(colour),
+                        BLUE_PORTION(colour), ZERO_ALPHA
+                      };
+    SDL_Surface *surface = TTF_RenderText_Solid(font, string, color);
+    SDL_Texture *texture = SDL_CreateTextureFromSurface(renderer, surface);
+    SDL_Rect dst = { 0 };
+    SDL_QueryTexture(texture, NULL, NULL, &dst.w, &dst.h);
+    dst.x = x;
+    dst.y = y;
+    SDL_RenderCopy(renderer, texture, NULL, &dst);
+    SDL_DestroyTexture(texture);
+    SDL_FreeSurface(surface);
+
+    return 0;
+}
+
+static int _getTextSize(char *string, int *width, int *height)
+{
+    unsigned long font_key = tumFontGetCurFontKey();
+    unsigned long hash = _hashString(string, font_key);
+    text_size_t *entry = &text_sizes[hash % TEXT_SIZE_CACHE_SIZE];
+    int w, h;
+
+    pthread_mutex_lock(&text_sizes_lock);
+    if (entry->valid && entry->font_key == font_key &&
+        entry->hash == hash && !strcmp(entry->str, string)) {
+        w = entry->w;
+        h = entry->h;
+        pthread_mutex_unlock(&text_sizes_lock);
+        goto out;
+    }
+    pthread_mutex_unlock(&text_sizes_lock);
+
+    TTF_Font *font = tumFontGetCurFont();
+    int ret = 0;
+
+    if (_isGlyphString(string)) {
+        // Same unkerned advances as _drawGlyphs() lays the glyphs out with
+        char *c;
+        int advance;
+
+        h = TTF_FontHeight(font);
+        for (w = 0, c = string; *c && !ret; c++) {
+            ret = TTF_GlyphMetrics(font, *c, NULL, NULL, NULL, NULL,
+                                   &advance);
+            w += advance;
+        }
+    }
+    else {
+        // Same metrics as TTF_RenderText_Solid uses for the size of its surface
+        ret = TTF_SizeText(font, string, &w, &h);
+    }
+    tumFontPutFont(font);
+    if (ret) {
+        return -1;
+    }
+
+    if (strlen(string) < TEXT_SIZE_MAX_LEN) {
+        pthread_mutex_lock(&text_sizes_lock);
+        entry->font_key = font_key;
+        entry->hash = hash;
+        strcpy(entry->str, string);
+        entry->w = w;
+        entry->h = h;
+        entry->valid = 1;
+        pthread_mutex_unlock(&text_sizes_lock);
+    }
+
+out:
+    if (width) {
+        *width = w;
+    }
+    if (height) {
+        *height = h;
+    }
+
+    return 0;
+}
+
+static int _drawArrow(signed short x1, signed short y1, signed short x2,
+                      signed short y2, signed short head_length,
+                      unsigned char thickness, unsigned int colour)
+{
+    // Line vector
+    unsigned short dx = x2 - x1;
+    unsigned short dy = y2 - y1;
+
+    // Normalize
+    float length = sqrt(dx * dx + dy * dy);
+    signed short unit_dx = (signed short)(dx / length);
+    signed short unit_dy = (signed short)(dy / length);
+
+    signed short head_x1 =
+        roundf(x2 - unit_dx * head_length - unit_dy * head_length);
+    signed short head_y1 =
+        roundf(y2 - unit_dy * head_length + unit_dx * head_length);
+
+    signed short head_x2 =
+        roundf(x2 - unit_dx * head_length + unit_dy * head_length);
+    signed short head_y2 =
+        roundf(y2 - unit_dy * head_length - unit_dx * head_length);
+
+    if (thickLineColor(renderer, x1, y1, x2, y2, thickness,
+                       SwapBytes((colour << ONE_BYTE) | ALPHA_SOLID))) {
+        return -1;
+    }
+    if (thickLineColor(renderer, head_x1, head_y1, x2, y2, thickness,
+                       SwapBytes((colour << ONE_BYTE) | ALPHA_SOLID))) {
+        return -1;
+    }
+    if (thickLineColor(renderer, head_x2, head_y2, x2, y2, thickness,
+                       SwapBytes((colour << ONE_BYTE) | ALPHA_SOLID))) {
+        return -1;
+    }
+
+    return 0;
+}
 
 static int vHandleDrawJob(draw_job_t *job)
 {
@@ -820,125 +1506,597 @@ static int vHandleDrawJob(draw_job_t *job)
         return -1;
     }
 
-    if (job->data == NULL) {
-        return -1;
-    }
-
     switch (job->type) {
         case DRAW_CLEAR:
-            ret = _clearDisplay(job->data->clear.colour);
+            ret = _clearDisplay(job->data.clear.colour);
             break;
         case DRAW_ARC:
-            ret = _drawArc(job->data->arc.x + x_offset,
-                           job->data->arc.y + y_offset,
-                           job->data->arc.radius, job->data->arc.start,
-                           job->data->arc.end, job->data->arc.colour);
+            ret = _drawArc(job->data.arc.x + x_offset,
+                           job->data.arc.y + y_offset,
+                           job->data.arc.radius, job->data.arc.start,
+                           job->data.arc.end, job->data.arc.colour);
             break;
         case DRAW_ELLIPSE:
-            ret = _drawEllipse(job->data->ellipse.x + x_offset,
-                               job->data->ellipse.y, job->data->ellipse.rx,
-                               job->data->ellipse.ry,
-                               job->data->ellipse.colour);
+            ret = _drawEllipse(job->data.ellipse.x + x_offset,
+                               job->data.ellipse.y, job->data.ellipse.rx,
+                               job->data.ellipse.ry,
+                               job->data.ellipse.colour);
             break;
         case DRAW_TEXT:
-            ret = _drawText(job->data->text.str,
-                            job->data->text.x + x_offset,
-                            job->data->text.y + y_offset,
-                            job->data->text.colour, job->data->text.font);
-            free(job->data->text.str);
+            ret = _drawText(job->data.text.str,
+                            job->data.text.x + x_offset,
+                            job->data.text.y + y_offset,
+                            job->data.text.colour,
+                            tumFontGetFontFromHandle(job->data.text.font),
+                            job->data.text.font_key);
+            tumFontPutFontHandle(job->data.text.font);
             break;
         case DRAW_RECT:
-            ret = _drawRectangle(job->data->rect.x + x_offset,
-                                 job->data->rect.y + y_offset,
-                                 job->data->rect.w, job->data->rect.h,
-                                 job->data->rect.colour);
+            ret = _drawRectangle(job->data.rect.x + x_offset,
+                                 job->data.rect.y + y_offset,
+                                 job->data.rect.w, job->data.rect.h,
+                                 job->data.rect.colour);
             break;
         case DRAW_FILLED_RECT:
-            ret = _drawFilledRectangle(job->data->rect.x + x_offset,
-                                       job->data->rect.y + y_offset,
-                                       job->data->rect.w, job->data->rect.h,
-                                       job->data->rect.colour);
+            ret = _drawFilledRectangle(job->data.rect.x + x_offset,
+                                       job->data.rect.y + y_offset,
+                                       job->data.rect.w, job->data.rect.h,
+                                       job->data.rect.colour);
             break;
         case DRAW_CIRCLE:
-            ret = _drawCircle(job->data->circle.x + x_offset,
-                              job->data->circle.y + y_offset,
-                              job->data->circle.radius,
-                              job->data->circle.colour);
+            ret = _drawCircle(job->data.circle.x + x_offset,
+                              job->data.circle.y + y_offset,
+                              job->data.circle.radius,
+                              job->data.circle.colour);
             break;
         case DRAW_LINE:
-            ret = _drawLine(job->data->line.x1 + x_offset,
-                            job->data->line.y1 + y_offset,
-                            job->data->line.x2 + x_offset,
-                            job->data->line.y2 + y_offset,
-                            job->data->line.thickness,
-                            job->data->line.colour);
+            ret = _drawLine(job->data.line.x1 + x_offset,
+                            job->data.line.y1 + y_offset,
+                            job->data.line.x2 + x_offset,
+                            job->data.line.y2 + y_offset,
+                            job->data.line.thickness,
+                            job->data.line.colour);
             break;
         case DRAW_POLY:
-            ret = _drawPoly(job->data->poly.points, job->data->poly.n,
-                            x_offset, y_offset, job->data->poly.colour);
+            ret = _drawPoly(job->data.poly.points, job->data.poly.n,
+                            x_offset, y_offset, job->data.poly.colour);
             break;
         case DRAW_TRIANGLE:
-            ret = _drawTriangle(job->data->triangle.points, x_offset,
-                                y_offset, job->data->triangle.colour);
+            ret = _drawTriangle(job->data.triangle.points, x_offset,
+                                y_offset, job->data.triangle.colour);
             break;
         case DRAW_IMAGE:
-            job->data->image.tex =
-                loadImage(job->data->image.filename, renderer);
-            ret = _drawImage(job->data->image.tex, renderer,
-                             job->data->image.x + x_offset,
-                             job->data->image.y + y_offset);
+            job->data.image.tex =
+                loadImage(job->data.image.filename, renderer);
+            ret = _drawImage(job->data.image.tex, renderer,
+                             job->data.image.x + x_offset,
+                             job->data.image.y + y_offset);
             break;
         case DRAW_LOADED_IMAGE:
-            ret = xDrawLoadedImage(job->data->loaded_image.img, renderer,
-                                   job->data->loaded_image.x + x_offset,
-                                   job->data->loaded_image.y + y_offset);
-            vPutLoadedImage(job->data->loaded_image.img);
+            ret = xDrawLoadedImage(job->data.loaded_image.img, renderer,
+                                   job->data.loaded_image.x + x_offset,
+                                   job->data.loaded_image.y + y_offset);
+            vPutLoadedImage(job->data.loaded_image.img);
             break;
         case DRAW_LOADED_IMAGE_CROP:
             ret = xDrawLoadedImageCropped(
-                      job->data->loaded_image_crop.image, renderer,
-                      job->data->loaded_image_crop.x + x_offset,
-                      job->data->loaded_image_crop.y + y_offset,
-                      job->data->loaded_image_crop.c_x,
-                      job->data->loaded_image_crop.c_y,
-                      job->data->loaded_image_crop.c_w,
-                      job->data->loaded_image_crop.c_h);
-            vPutLoadedImage(job->data->loaded_image_crop.image);
+                      job->data.loaded_image_crop.image, renderer,
+                      job->data.loaded_image_crop.x + x_offset,
+                      job->data.loaded_image_crop.y + y_offset,
+                      job->data.loaded_image_crop.c_x,
+                      job->data.loaded_image_crop.c_y,
+                      job->data.loaded_image_crop.c_w,
+                      job->data.loaded_image_crop.c_h);
+            vPutLoadedImage(job->data.loaded_image_crop.image);
+            break;
+        case DRAW_IMAGE_BATCH:
+            ret = _drawImageBatch(job->data.image_batch.atlas,
+                                  job->data.image_batch.regions,
+                                  job->data.image_batch.positions,
+                                  job->data.image_batch.count, x_offset,
+                                  y_offset);
+            vPutLoadedImage(job->data.image_batch.atlas);
             break;
         case DRAW_SCALED_IMAGE:
-            job->data->scaled_image.image.tex = loadImage(
-                                                    job->data->scaled_image.image.filename, renderer);
+            job->data.scaled_image.image.tex = loadImage(
+                                                    job->data.scaled_image.image.filename, renderer);
             ret = _drawScaledImage(
-                      job->data->scaled_image.image.tex, renderer,
-                      job->data->scaled_image.image.x + x_offset,
-                      job->data->scaled_image.image.y + y_offset,
-                      job->data->scaled_image.scale);
-            free(job->data->scaled_image.image.filename);
+                      job->data.scaled_image.image.tex, renderer,
+                      job->data.scaled_image.image.x + x_offset,
+                      job->data.scaled_image.image.y + y_offset,
+                      job->data.scaled_image.scale);
             break;
         case DRAW_ARROW:
-            ret = _drawArrow(job->data->arrow.x1 + x_offset,
-                             job->data->arrow.y1 + y_offset,
-                             job->data->arrow.x2 + x_offset,
-                             job->data->arrow.y2 + y_offset,
-                             job->data->arrow.head_length,
-                             job->data->arrow.thickness,
-                             job->data->arrow.colour);
+            ret = _drawArrow(job->data.arrow.x1 + x_offset,
+                             job->data.arrow.y1 + y_offset,
+                             job->data.arrow.x2 + x_offset,
+                             job->data.arrow.y2 + y_offset,
+                             job->data.arrow.head_length,
+                             job->data.arrow.thickness,
+                             job->data.arrow.colour);
+            break;
+        case DRAW_LAYER_BEGIN:
+            ret = _beginLayer(job->data.layer.layer);
+            vPutLayer(job->data.layer.layer);
+            break;
+        case DRAW_LAYER_END:
+            ret = _setScreenTarget();
+            break;
+        case DRAW_LAYER:
+            ret = _drawLayer(job->data.layer.layer,
+                             job->data.layer.x + x_offset,
+                             job->data.layer.y + y_offset);
+            vPutLayer(job->data.layer.layer);
+            break;
+        default:
+            break;
+    }
+
+    return ret;
+}
+
+static void vReleaseDrawJob(draw_job_t *job)
+{
+    switch (job->type) {
+        case DRAW_TEXT:
+            tumFontPutFontHandle(job->data.text.font);
+            break;
+        case DRAW_LOADED_IMAGE:
+            vPutLoadedImage(job->data.loaded_image.img);
+            break;
+        case DRAW_LOADED_IMAGE_CROP:
+            vPutLoadedImage(job->data.loaded_image_crop.image);
+            break;
+        case DRAW_IMAGE_BATCH:
+            vPutLoadedImage(job->data.image_batch.atlas);
+            break;
+        case DRAW_LAYER_BEGIN:
+        case DRAW_LAYER:
+            vPutLayer(job->data.layer.layer);
+            break;
         default:
             break;
     }
-    free(job->data);
+}
+
+static void *_jobDup(draw_list_t *list, void *src, size_t size)
+{
+    void *ret = _jobAlloc(&list->arena, size);
+
+    if (ret) {
+        memcpy(ret, src, size);
+    }
 
     return ret;
 }
 
+// The copy takes over the references of the job
+static draw_job_t *_copyDrawJob(draw_list_t *list, draw_job_t *job)
+{
+    draw_job_t *copy = _jobDup(list, job, sizeof(draw_job_t));
+
+    if (copy == NULL) {
+        return NULL;
+    }
+
+    copy->next = NULL;
+
+    switch (job->type) {
+        case DRAW_TEXT:
+            copy->data.text.str = _jobDup(list, job->data.text.str,
+                                          strlen(job->data.text.str) + 1);
+            return copy->data.text.str ? copy : NULL;
+        case DRAW_POLY:
+            copy->data.poly.points =
+                _jobDup(list, job->data.poly.points,
+                        job->data.poly.n * sizeof(coord_t));
+            return copy->data.poly.points ? copy : NULL;
+        case DRAW_TRIANGLE:
+            copy->data.triangle.points =
+                _jobDup(list, job->data.triangle.points,
+                        3 * sizeof(coord_t));
+            return copy->data.triangle.points ? copy : NULL;
+        case DRAW_IMAGE:
+            copy->data.image.filename =
+                _jobDup(list, job->data.image.filename,
+                        strlen(job->data.image.filename) + 1);
+            return copy->data.image.filename ? copy : NULL;
+        case DRAW_SCALED_IMAGE:
+            copy->data.scaled_image.image.filename = _jobDup(
+                        list, job->data.scaled_image.image.filename,
+                        strlen(job->data.scaled_image.image.filename) + 1);
+            return copy->data.scaled_image.image.filename ? copy : NULL;
+        case DRAW_IMAGE_BATCH:
+            copy->data.image_batch.regions =
+                _jobDup(list, job->data.image_batch.regions,
+                        job->data.image_batch.count * sizeof(unsigned));
+            copy->data.image_batch.positions =
+                _jobDup(list, job->data.image_batch.positions,
+                        job->data.image_batch.count * sizeof(coord_t));
+            return copy->data.image_batch.regions &&
+                   copy->data.image_batch.positions ? copy : NULL;
+        default:
+            return copy;
+    }
+}
+
+static int _beginsLayer(draw_list_t *list, layer_t *layer)
+{
+    draw_job_t *job = list->head.next;
+
+    for (; job; job = job->next)
+        if (job->type == DRAW_LAYER_BEGIN && job->data.layer.layer == layer) {
+            return 1;
+        }
+
+    return 0;
+}
+
+/*
+ * Layers recorded in a frame that is dropped are drawn with the frame
+ * replacing it, unless that frame draws them again. Their jobs are copied in
+ * front of the newer frame & unlinked from the dropped one.
+ */
+static void _moveLayers(draw_list_t *dropped, draw_list_t *list)
+{
+    draw_job_t moved = { 0 };
+    draw_job_t *moved_tail = &moved;
+    draw_job_t *prev = &dropped->head;
+
+    while (prev->next) {
+        draw_job_t *begin = prev->next;
+
+        if (begin->type != DRAW_LAYER_BEGIN ||
+            _beginsLayer(list, begin->data.layer.layer)) {
+            prev = begin;
+            continue;
+        }
+
+        draw_job_t copies = { 0 };
+        draw_job_t *copies_tail = &copies;
+        draw_job_t *end = begin;
+        int failed = 0;
+
+        for (; end; end = end->next) {
+            copies_tail->next = _copyDrawJob(list, end);
+            if (copies_tail->next == NULL) {
+                failed = 1;
+                break;
+            }
+            copies_tail = copies_tail->next;
+
+            if (end->type == DRAW_LAYER_END) {
+                break;
+            }
+        }
+
+        // Out of memory, the layer is released & has to be drawn again
+        if (failed) {
+            vSetLayerValid(begin->data.layer.layer, 0);
+            prev = begin;
+            continue;
+        }
+
+        prev->next = end ? end->next : NULL;
+        moved_tail->next = copies.next;
+        moved_tail = copies_tail;
+    }
+
+    if (moved.next) {
+        moved_tail->next = list->head.next;
+        list->head.next = moved.next;
+        if (list->tail == &list->head) {
+            list->tail = moved_tail;
+        }
+    }
+}
+
+static void _getPointsBounds(coord_t *points, unsigned int n, SDL_Rect *bbox)
+{
+    int min_x = points[0].x, max_x = points[0].x;
+    int min_y = points[0].y, max_y = points[0].y;
+    unsigned int i;
+
+    for (i = 1; i < n; i++) {
+        min_x = points[i].x < min_x ? points[i].x : min_x;
+        max_x = points[i].x > max_x ? points[i].x : max_x;
+        min_y = points[i].y < min_y ? points[i].y : min_y;
+        max_y = points[i].y > max_y ? points[i].y : max_y;
+    }
+
+    *bbox = (SDL_Rect){ min_x, min_y, max_x - min_x + 1, max_y - min_y + 1 };
+}
+
+static void _getLineBounds(signed short x1, signed short y1, signed short x2,
+                           signed short y2, int width, SDL_Rect *bbox)
+{
+    coord_t points[2] = { { x1, y1 }, { x2, y2 } };
+
+    _getPointsBounds(points, 2, bbox);
+    bbox->x -= width;
+    bbox->y -= width;
+    bbox->w += 2 * width;
+    bbox->h += 2 * width;
+}
+
+/*
+ * Region of the screen a job draws to, without the global offset. Jobs
+ * whose size is not known without loading a file cover the whole screen.
+ */
+static void _getJobBounds(draw_job_t *job, SDL_Rect *bbox)
+{
+    SDL_Rect screen_rect = { 0, 0, SCREEN_WIDTH, SCREEN_HEIGHT };
+    union data_u *data = &job->data;
+    TTF_Font *font;
+    int w = 0, h = 0;
+    unsigned i;
+
+    *bbox = (SDL_Rect){ 0 };
+
+    switch (job->type) {
+        case DRAW_ARC:
+            *bbox = (SDL_Rect){ data->arc.x - data->arc.radius,
+                                data->arc.y - data->arc.radius,
+                                2 * data->arc.radius + 1,
+                                2 * data->arc.radius + 1
+                              };
+            break;
+        case DRAW_ELLIPSE:
+            *bbox = (SDL_Rect){ data->ellipse.x - data->ellipse.rx,
+                                data->ellipse.y - data->ellipse.ry,
+                                2 * data->ellipse.rx + 1,
+                                2 * data->ellipse.ry + 1
+                              };
+            break;
+        case DRAW_CIRCLE:
+            *bbox = (SDL_Rect){ data->circle.x - data->circle.radius,
+                                data->circle.y - data->circle.radius,
+                                2 * data->circle.radius + 1,
+                                2 * data->circle.radius + 1
+                              };
+            break;
+        case DRAW_TEXT:
+            font = tumFontGetFontFromHandle(data->text.font);
+            if (font == NULL ||
+                TTF_SizeText(font, data->text.str, &w, &h)) {
+                *bbox = screen_rect;
+                break;
+            }
+            // Glyphs from the atlas may reach past the measured width
+            *bbox = (SDL_Rect){ data->text.x - h / 4, data->text.y,
+                                w + h / 2, h
+                              };
+            break;
+        case DRAW_RECT:
+        case DRAW_FILLED_RECT:
+            *bbox = (SDL_Rect){ data->rect.x, data->rect.y,
+                                data->rect.w + 1, data->rect.h + 1
+                              };
+            break;
+        case DRAW_LINE:
+            _getLineBounds(data->line.x1, data->line.y1, data->line.x2,
+                           data->line.y2, data->line.thickness, bbox);
+            break;
+        case DRAW_ARROW:
+            _getLineBounds(data->arrow.x1, data->arrow.y1, data->arrow.x2,
+                           data->arrow.y2,
+                           data->arrow.thickness +
+                           2 * abs(data->arrow.head_length),
+                           bbox);
+            break;
+        case DRAW_POLY:
+            _getPointsBounds(data->poly.points, data->poly.n, bbox);
+            break;
+        case DRAW_TRIANGLE:
+            _getPointsBounds(data->triangle.points, 3, bbox);
+            break;
+        case DRAW_LOADED_IMAGE:
+            *bbox = (SDL_Rect){ data->loaded_image.x, data->loaded_image.y,
+                                data->loaded_image.img->w *
+                                data->loaded_image.img->scale,
+                                data->loaded_image.img->h *
+                                data->loaded_image.img->scale
+                              };
+            break;
+        case DRAW_LOADED_IMAGE_CROP:
+            *bbox = (SDL_Rect){ data->loaded_image_crop.x,
+                                data->loaded_image_crop.y,
+                                data->loaded_image_crop.c_w,
+                                data->loaded_image_crop.c_h
+                              };
+            break;
+        case DRAW_IMAGE_BATCH:
+            for (i = 0; i < data->image_batch.count; i++) {
+                loaded_image_t *atlas = data->image_batch.atlas;
+
+                if (data->image_batch.regions[i] >= atlas->regions_count) {
+                    continue;
+                }
+
+                SDL_Rect *src = &atlas->regions[data->image_batch.regions[i]];
+                SDL_Rect dst = { data->image_batch.positions[i].x,
+                                 data->image_batch.positions[i].y,
+                                 src->w * atlas->scale + 1,
+                                 src->h * atlas->scale + 1
+                               };
+
+                if (bbox->w) {
+                    SDL_UnionRect(bbox, &dst, bbox);
+                }
+                else {
+                    *bbox = dst;
+                }
+            }
+            break;
+        case DRAW_LAYER:
+            *bbox = (SDL_Rect){ data->layer.x, data->layer.y,
+                                data->layer.layer->w, data->layer.layer->h
+                              };
+            break;
+        case DRAW_LAYER_BEGIN:
+        case DRAW_LAYER_END:
+        case DRAW_NONE:
+            return;
+        default:
+            *bbox = screen_rect;
+            return;
+    }
+
+    if (bbox->w && bbox->h) {
+        bbox->x -= DAMAGE_PADDING;
+        bbox->y -= DAMAGE_PADDING;
+        bbox->w += 2 * DAMAGE_PADDING;
+        bbox->h += 2 * DAMAGE_PADDING;
+    }
+}
+
+static int _jobsEqual(draw_job_t *a, draw_job_t *b)
+{
+    if (a->type != b->type || !SDL_RectEquals(&a->bbox, &b->bbox)) {
+        return 0;
+    }
+
+    switch (a->type) {
+        case DRAW_TEXT:
+            return a->data.text.x == b->data.text.x &&
+                   a->data.text.y == b->data.text.y &&
+                   a->data.text.colour == b->data.text.colour &&
+                   a->data.text.font_key == b->data.text.font_key &&
+                   !strcmp(a->data.text.str, b->data.text.str);
+        case DRAW_POLY:
+            return a->data.poly.n == b->data.poly.n &&
+                   a->data.poly.colour == b->data.poly.colour &&
+                   !memcmp(a->data.poly.points, b->data.poly.points,
+                           a->data.poly.n * sizeof(coord_t));
+        case DRAW_TRIANGLE:
+            return a->data.triangle.colour == b->data.triangle.colour &&
+                   !memcmp(a->data.triangle.points, b->data.triangle.points,
+                           3 * sizeof(coord_t));
+        case DRAW_IMAGE_BATCH:
+            return a->data.image_batch.atlas == b->data.image_batch.atlas &&
+                   a->data.image_batch.count == b->data.image_batch.count &&
+                   !memcmp(a->data.image_batch.regions,
+                           b->data.image_batch.regions,
+                           a->data.image_batch.count * sizeof(unsigned)) &&
+                   !memcmp(a->data.image_batch.positions,
+                           b->data.image_batch.positions,
+                           a->data.image_batch.count * sizeof(coord_t));
+        case DRAW_IMAGE:
+        case DRAW_SCALED_IMAGE:
+            // Files can change between frames
+            return 0;
+        default:
+            // Jobs are zeroed when pushed, so padding compares equal
+            return !memcmp(&a->data, &b->data, sizeof(union data_u));
+    }
+}
+
+static void _addDamage(SDL_Rect *rect)
+{
+    if (!rect->w || !rect->h) {
+        return;
+    }
+
+    if (screen.damage.w && screen.damage.h) {
+        SDL_UnionRect(&screen.damage, rect, &screen.damage);
+    }
+    else {
+        screen.damage = *rect;
+    }
+}
+
+/*
+ * Compares the frame with the previously drawn one, job by job. Pixels
+ * outside of the jobs that differ are covered by the same jobs in the same
+ * order in both frames, so they don't change. Returns 1 if a layer is drawn
+ * into, even if the screen is not damaged.
+ */
+static int _findDamage(draw_list_t *list, draw_list_t *previous, int x_offset,
+                       int y_offset)
+{
+    SDL_Rect screen_rect = { 0, 0, SCREEN_WIDTH, SCREEN_HEIGHT };
+    draw_job_t *job, *previous_job;
+    int in_layer = 0, layers_drawn = 0;
+
+    for (job = list->head.next; job; job = job->next) {
+        if (job->type == DRAW_LAYER_BEGIN) {
+            job->data.layer.layer->redrawn = 1;
+            layers_drawn = 1;
+            in_layer = 1;
+        }
+        else if (job->type == DRAW_LAYER_END) {
+            in_layer = 0;
+        }
+
+        // Jobs drawn into layers don't touch the screen
+        if (in_layer) {
+            job->bbox = (SDL_Rect){ 0 };
+        }
+        else {
+            _getJobBounds(job, &job->bbox);
+        }
+    }
+
+    screen.damage = (SDL_Rect){ 0 };
+
+    if (__atomic_exchange_n(&screen.full, 0, __ATOMIC_ACQ_REL) ||
+        screen.tex == NULL || x_offset != screen.x_offset ||
+        y_offset != screen.y_offset) {
+        screen.damage = screen_rect;
+    }
+    else {
+        for (job = list->head.next, previous_job = previous->head.next;
+             job || previous_job;
+             job = job ? job->next : NULL,
+             previous_job = previous_job ? previous_job->next : NULL) {
+            if (job && previous_job && _jobsEqual(job, previous_job) &&
+                !(job->type == DRAW_LAYER && job->data.layer.layer->redrawn)) {
+                continue;
+            }
+
+            if (job) {
+                _addDamage(&job->bbox);
+            }
+            if (previous_job) {
+                _addDamage(&previous_job->bbox);
+            }
+        }
+
+        // The jobs are drawn shifted by the global offset
+        screen.damage.x += x_offset;
+        screen.damage.y += y_offset;
+
+        if (!SDL_IntersectRect(&screen.damage, &screen_rect,
+                               &screen.damage)) {
+            screen.damage = (SDL_Rect){ 0 };
+        }
+    }
+
+    for (job = list->head.next; job; job = job->next)
+        if (job->type == DRAW_LAYER_BEGIN) {
+            job->data.layer.layer->redrawn = 0;
+        }
+
+    screen.x_offset = x_offset;
+    screen.y_offset = y_offset;
+
+    return layers_drawn;
+}
+
+// The drawn frame is compared with the next one
+static void _keepFrame(void)
+{
+    draw_list_t *drawn_list = previous_list;
+
+    previous_list = render_list;
+    render_list = drawn_list;
+    resetDrawList(render_list);
+}
+
 #define INIT_JOB(JOB, TYPE)                                                    \
     draw_job_t *JOB = pushDrawJob();                                       \
     if (!JOB)                                                              \
         return -1;                                                     \
-    union data_u *data = calloc(1, sizeof(union data_u));                  \
-    if (data == NULL)                                                      \
-        logCriticalError("job->data alloc");                           \
-    JOB->data = data;                                                      \
     JOB->type = TYPE;
 
 static void logCriticalError(char *msg)
@@ -971,6 +2129,36 @@ static float timespecDiffMilli(struct timespec *start, struct timespec *stop)
 #define FRAMELIMIT_PERIOD 1000.0 / FRAMELIMIT
 #endif //configFPS_LIMIT
 
+int tumDrawSubmitFrame(void)
+{
+    pthread_mutex_lock(&draw_lists_lock);
+
+    // A frame that was not drawn yet is replaced by the newer one
+    unsigned char dropped = frame_ready;
+    if (dropped) {
+        _moveLayers(ready_list, record_list);
+    }
+
+    draw_list_t *tmp_list = ready_list;
+    ready_list = record_list;
+    record_list = tmp_list;
+    frame_ready = 1;
+
+    pthread_mutex_unlock(&draw_lists_lock);
+
+    // The dropped frame now belongs to the recording task again
+    if (dropped) {
+        draw_job_t *tmp_job;
+
+        while ((tmp_job = popDrawJob(record_list)) != NULL) {
+            vReleaseDrawJob(tmp_job);
+        }
+    }
+    resetDrawList(record_list);
+
+    return 0;
+}
+
 int tumDrawUpdateScreen(void)
 {
     if (tumUtilIsCurGLThread()) {
@@ -994,32 +2182,97 @@ int tumDrawUpdateScreen(void)
     memcpy(&last_time, &cur_time, sizeof(struct timespec));
 #endif //configFPS_LIMIT
 
-    if (job_list_head.next == NULL) {
-        goto err;
+    // The frame is drawn next time, if the recording task is swapping lists
+    if (pthread_mutex_trylock(&draw_lists_lock)) {
+        return 1;
+    }
+    if (!frame_ready) {
+        pthread_mutex_unlock(&draw_lists_lock);
+        return 1;
     }
 
+    draw_list_t *tmp_list = render_list;
+    render_list = ready_list;
+    ready_list = tmp_list;
+    frame_ready = 0;
+    pthread_mutex_unlock(&draw_lists_lock);
+
     draw_job_t *tmp_job;
+    int ret = 0;
+    int x_offset = screen.x_offset, y_offset = screen.y_offset;
 
-    while ((tmp_job = popDrawJob()) != NULL) {
-        if (!tmp_job->data) {
-            return -1;
+    // The offsets of the last frame are kept, if the lock is taken
+    if (!pthread_mutex_trylock(&global_offset.lock)) {
+        x_offset = global_offset.x;
+        y_offset = global_offset.y;
+        pthread_mutex_unlock(&global_offset.lock);
+    }
+
+    if (screen.tex == NULL) {
+        screen.tex = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888,
+                                       SDL_TEXTUREACCESS_TARGET,
+                                       SCREEN_WIDTH, SCREEN_HEIGHT);
+        if (screen.tex) {
+            SDL_SetTextureBlendMode(screen.tex, SDL_BLENDMODE_NONE);
+        }
+        __atomic_store_n(&screen.full, 1, __ATOMIC_RELEASE);
+    }
+
+    int layers_drawn =
+        _findDamage(render_list, previous_list, x_offset, y_offset);
+
+    // Nothing changed, the jobs only have to put their references
+    if (!screen.damage.w && !layers_drawn) {
+        for (tmp_job = render_list->head.next; tmp_job;
+             tmp_job = tmp_job->next) {
+            vReleaseDrawJob(tmp_job);
         }
+        _keepFrame();
+        return 1;
+    }
+
+    if (_setScreenTarget()) {
+        PRINT_SDL_ERROR("Failed to set screen as render target");
+        ret = -1;
+    }
+
+    // All jobs are handled, so their references are put before the reset
+    for (tmp_job = render_list->head.next; tmp_job; tmp_job = tmp_job->next)
         if (vHandleDrawJob(tmp_job) == -1) {
-            goto draw_error;
+            ret = -1;
         }
-        free(tmp_job);
+
+    if (screen.tex) {
+        SDL_RenderSetClipRect(renderer, NULL);
+        SDL_SetRenderTarget(renderer, NULL);
+        SDL_RenderCopy(renderer, screen.tex, NULL, NULL);
     }
 
-    SDL_RenderPresent(renderer);
+    if (ret) {
+        __atomic_store_n(&screen.full, 1, __ATOMIC_RELEASE);
+    }
+    else if (screen.damage.w) {
+        SDL_RenderPresent(renderer);
+    }
 
-    return 0;
+    _keepFrame();
+
+    if (ret) {
+        goto err;
+    }
+
+    // Only layers were drawn, the screen shows them with a later frame
+    return screen.damage.w ? 0 : 1;
 
-draw_error:
-    free(tmp_job);
 err:
     return -1;
 }
 
+void tumDrawInvalidateScreen(void)
+{
+    __atomic_store_n(&screen.full, 1, __ATOMIC_RELEASE);
+}
+
 char *tumGetErrorMessage(void)
 {
     return error_message;
@@ -1042,6 +2295,16 @@ int tumDrawInit(char *path) // Should be called from the Thread running main()
 #error "Unexpected value of HOST_OS!"
 #endif /* HOST_OS */
 #endif /* DOCKER */
+    const char *backend = SDL_getenv(TUM_DRAW_BACKEND_ENV);
+    int use_offscreen =
+        backend && !strcmp(backend, TUM_DRAW_BACKEND_SOFTWARE);
+
+    if (use_offscreen) {
+        // No display or sound card is needed, unless a driver is chosen
+        setenv("SDL_VIDEODRIVER", "dummy", 0);
+        setenv("SDL_AUDIODRIVER", "dummy", 0);
+    }
+
     SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, "linear");
 
     if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_EVENTS | SDL_INIT_AUDIO)) {
@@ -1058,6 +2321,18 @@ int tumDrawInit(char *path) // Should be called from the Thread running main()
         goto err_tum_font;
     }
 
+    if (use_offscreen) {
+        offscreen = SDL_CreateRGBSurfaceWithFormat(
+                        0, screen_width, screen_height, 32,
+                        SDL_PIXELFORMAT_RGBA8888);
+        if (offscreen == NULL) {
+            PRINT_SDL_ERROR("Failed to create %d x %d offscreen surface",
+                            screen_width, screen_height);
+            goto err_window;
+        }
+        goto bind_thread;
+    }
+
     window = SDL_CreateWindow(WINDOW_TITLE, SDL_WINDOWPOS_CENTERED,
                               SDL_WINDOWPOS_CENTERED, screen_width,
                               screen_height, SDL_WINDOW_OPENGL);
@@ -1085,6 +2360,7 @@ int tumDrawInit(char *path) // Should be called from the Thread running main()
         goto err_make_current;
     }
 
+bind_thread:
     tumDrawBindThread();
 
     atexit(SDL_Quit);
@@ -1107,20 +2383,47 @@ err_sdl:
 
 int tumDrawBindThread(void) // Should be called from the Drawing Thread
 {
-    if (SDL_GL_MakeCurrent(window, context) < 0) {
+    if (offscreen == NULL && SDL_GL_MakeCurrent(window, context) < 0) {
         PRINT_SDL_ERROR("Releasing current context failed");
         goto err_make_current;
     }
 
+    // Textures of layers & glyphs belong to the old renderer
+    pthread_mutex_lock(&layers_lock);
+    layer_t *layer = layers_list.next;
+
+    for (; layer; layer = layer->next) {
+        if (layer->tex) {
+            SDL_DestroyTexture(layer->tex);
+            layer->tex = NULL;
+        }
+        vSetLayerValid(layer, 0);
+    }
+
+    pthread_mutex_unlock(&layers_lock);
+
+    _freeGlyphAtlas();
+
+    if (screen.tex) {
+        SDL_DestroyTexture(screen.tex);
+        screen.tex = NULL;
+    }
+    __atomic_store_n(&screen.full, 1, __ATOMIC_RELEASE);
+
     if (renderer) {
         SDL_DestroyRenderer(renderer);
         renderer = NULL;
     }
 
-    renderer = SDL_CreateRenderer(window, -1,
-                                  SDL_RENDERER_ACCELERATED |
-                                  SDL_RENDERER_TARGETTEXTURE |
-                                  SDL_RENDERER_PRESENTVSYNC);
+    if (offscreen) {
+        renderer = SDL_CreateSoftwareRenderer(offscreen);
+    }
+    else {
+        renderer = SDL_CreateRenderer(window, -1,
+                                      SDL_RENDERER_ACCELERATED |
+                                      SDL_RENDERER_TARGETTEXTURE |
+                                      SDL_RENDERER_PRESENTVSYNC);
+    }
 
     if (renderer == NULL) {
         PRINT_SDL_ERROR("Failed to create renderer");
@@ -1167,6 +2470,10 @@ void tumDrawExit(void)
         SDL_DestroyRenderer(renderer);
     }
 
+    if (offscreen) {
+        SDL_FreeSurface(offscreen);
+    }
+
     TTF_Quit();
     SDL_Quit();
 
@@ -1181,18 +2488,18 @@ int tumDrawText(char *str, signed short x, signed short y, unsigned int colour)
 
     INIT_JOB(job, DRAW_TEXT);
 
-    job->data->text.str = (char *)calloc(strlen(str) + 1, sizeof(char));
+    job->data.text.str = jobStrdup(str);
 
-    if (job->data->text.str == NULL) {
+    if (job->data.text.str == NULL) {
         printf("Error allocating buffer in tumDrawText\n");
         return -1;
     }
 
-    strcpy(job->data->text.str, str);
-    job->data->text.font = tumFontGetCurFont();
-    job->data->text.x = x;
-    job->data->text.y = y;
-    job->data->text.colour = colour;
+    job->data.text.font = tumFontGetCurFontHandle();
+    job->data.text.font_key = tumFontGetCurFontKey();
+    job->data.text.x = x;
+    job->data.text.y = y;
+    job->data.text.colour = colour;
 
     return 0;
 }
@@ -1210,11 +2517,11 @@ int tumDrawEllipse(signed short x, signed short y, signed short rx,
 {
     INIT_JOB(job, DRAW_ELLIPSE);
 
-    job->data->ellipse.x = x;
-    job->data->ellipse.y = y;
-    job->data->ellipse.rx = rx;
-    job->data->ellipse.ry = ry;
-    job->data->ellipse.colour = colour;
+    job->data.ellipse.x = x;
+    job->data.ellipse.y = y;
+    job->data.ellipse.rx = rx;
+    job->data.ellipse.ry = ry;
+    job->data.ellipse.colour = colour;
 
     return 0;
 }
@@ -1224,12 +2531,12 @@ int tumDrawArc(signed short x, signed short y, signed short radius,
 {
     INIT_JOB(job, DRAW_ARC);
 
-    job->data->arc.x = x;
-    job->data->arc.y = y;
-    job->data->arc.radius = radius;
-    job->data->arc.start = start;
-    job->data->arc.end = end;
-    job->data->arc.colour = colour;
+    job->data.arc.x = x;
+    job->data.arc.y = y;
+    job->data.arc.radius = radius;
+    job->data.arc.start = start;
+    job->data.arc.end = end;
+    job->data.arc.colour = colour;
 
     return 0;
 }
@@ -1239,11 +2546,11 @@ int tumDrawFilledBox(signed short x, signed short y, signed short w,
 {
     INIT_JOB(job, DRAW_FILLED_RECT);
 
-    job->data->rect.x = x;
-    job->data->rect.y = y;
-    job->data->rect.w = w;
-    job->data->rect.h = h;
-    job->data->rect.colour = colour;
+    job->data.rect.x = x;
+    job->data.rect.y = y;
+    job->data.rect.w = w;
+    job->data.rect.h = h;
+    job->data.rect.colour = colour;
 
     return 0;
 }
@@ -1253,11 +2560,11 @@ int tumDrawBox(signed short x, signed short y, signed short w, signed short h,
 {
     INIT_JOB(job, DRAW_RECT);
 
-    job->data->rect.x = x;
-    job->data->rect.y = y;
-    job->data->rect.w = w;
-    job->data->rect.h = h;
-    job->data->rect.colour = colour;
+    job->data.rect.x = x;
+    job->data.rect.y = y;
+    job->data.rect.w = w;
+    job->data.rect.h = h;
+    job->data.rect.colour = colour;
 
     return 0;
 }
@@ -1279,16 +2586,9 @@ void tumDrawDuplicateBuffer(void)
 
 int tumDrawClear(unsigned int colour)
 {
-    /** INIT_JOB(job, DRAW_CLEAR); */
-    draw_job_t *job = pushDrawJob();
-    union data_u *data = calloc(1, sizeof(union data_u));
-    if (data == NULL) {
-        logCriticalError("job->data alloc");
-    }
-    job->data = data;
-    job->type = DRAW_CLEAR;
+    INIT_JOB(job, DRAW_CLEAR);
 
-    job->data->clear.colour = colour;
+    job->data.clear.colour = colour;
 
     return 0;
 }
@@ -1298,10 +2598,10 @@ int tumDrawCircle(signed short x, signed short y, signed short radius,
 {
     INIT_JOB(job, DRAW_CIRCLE);
 
-    job->data->circle.x = x;
-    job->data->circle.y = y;
-    job->data->circle.radius = radius;
-    job->data->circle.colour = colour;
+    job->data.circle.x = x;
+    job->data.circle.y = y;
+    job->data.circle.radius = radius;
+    job->data.circle.colour = colour;
 
     return 0;
 }
@@ -1311,12 +2611,12 @@ int tumDrawLine(signed short x1, signed short y1, signed short x2,
 {
     INIT_JOB(job, DRAW_LINE);
 
-    job->data->line.x1 = x1;
-    job->data->line.y1 = y1;
-    job->data->line.x2 = x2;
-    job->data->line.y2 = y2;
-    job->data->line.thickness = thickness;
-    job->data->line.colour = colour;
+    job->data.line.x1 = x1;
+    job->data.line.y1 = y1;
+    job->data.line.x2 = x2;
+    job->data.line.y2 = y2;
+    job->data.line.thickness = thickness;
+    job->data.line.colour = colour;
 
     return 0;
 }
@@ -1325,16 +2625,16 @@ int tumDrawPoly(coord_t *points, int n, unsigned int colour)
 {
     INIT_JOB(job, DRAW_POLY);
 
-    coord_t *points_cpy = (coord_t *)calloc(n, sizeof(coord_t));
+    coord_t *points_cpy = (coord_t *)jobAlloc(n * sizeof(coord_t));
     if (!points_cpy) {
         return -1;
     }
 
     memcpy(points_cpy, points, sizeof(coord_t) * n);
 
-    job->data->poly.points = points_cpy;
-    job->data->poly.n = n;
-    job->data->poly.colour = colour;
+    job->data.poly.points = points_cpy;
+    job->data.poly.n = n;
+    job->data.poly.colour = colour;
 
     return 0;
 }
@@ -1343,15 +2643,15 @@ int tumDrawTriangle(coord_t *points, unsigned int colour)
 {
     INIT_JOB(job, DRAW_TRIANGLE);
 
-    coord_t *points_cpy = (coord_t *)calloc(3, sizeof(coord_t));
+    coord_t *points_cpy = (coord_t *)jobAlloc(3 * sizeof(coord_t));
     if (!points_cpy) {
         return -1;
     }
 
     memcpy(points_cpy, points, sizeof(coord_t) * 3);
 
-    job->data->triangle.points = points_cpy;
-    job->data->triangle.colour = colour;
+    job->data.triangle.points = points_cpy;
+    job->data.triangle.colour = colour;
 
     return 0;
 }
@@ -1452,9 +2752,130 @@ int tumDrawLoadedImage(image_handle_t img, signed short x, signed short y)
     INIT_JOB(job, DRAW_LOADED_IMAGE);
 
     ((loaded_image_t *)img)->ref_count++;
-    job->data->loaded_image.img = img;
-    job->data->loaded_image.x = x;
-    job->data->loaded_image.y = y;
+    job->data.loaded_image.img = img;
+    job->data.loaded_image.x = x;
+    job->data.loaded_image.y = y;
+
+    return 0;
+}
+
+image_handle_t tumDrawCreateAtlas(image_handle_t images[], unsigned count)
+{
+    loaded_image_t **imgs = (loaded_image_t **)images;
+    unsigned i;
+    int w = 0, h = 0;
+
+    if (images == NULL || count == 0) {
+        PRINT_ERROR("Atlas requires at least one image");
+        goto err_alloc;
+    }
+
+    for (i = 0; i < count; i++) {
+        if (imgs[i] == NULL || imgs[i]->surf == NULL) {
+            PRINT_ERROR("Image %u of atlas is not valid", i);
+            goto err_alloc;
+        }
+        w += imgs[i]->surf->w + ATLAS_PADDING;
+        if (imgs[i]->surf->h > h) {
+            h = imgs[i]->surf->h;
+        }
+    }
+
+    loaded_image_t *ret = calloc(1, sizeof(loaded_image_t));
+    if (ret == NULL) {
+        PRINT_ERROR("Failed to allocate atlas");
+        goto err_alloc;
+    }
+
+    ret->regions = calloc(count, sizeof(SDL_Rect));
+    if (ret->regions == NULL) {
+        PRINT_ERROR("Failed to allocate atlas regions");
+        goto err_regions;
+    }
+
+    ret->surf = SDL_CreateRGBSurfaceWithFormat(0, w, h, 32,
+                SDL_PIXELFORMAT_RGBA32);
+    if (ret->surf == NULL) {
+        PRINT_SDL_ERROR("Failed to create atlas surface");
+        goto err_surf;
+    }
+
+    // The images are copied as they are, including their alpha
+    for (i = 0, w = 0; i < count; i++) {
+        SDL_Rect *region = &ret->regions[i];
+        SDL_BlendMode blend_mode;
+        region->x = w;
+        region->w = imgs[i]->surf->w;
+        region->h = imgs[i]->surf->h;
+        SDL_GetSurfaceBlendMode(imgs[i]->surf, &blend_mode);
+        SDL_SetSurfaceBlendMode(imgs[i]->surf, SDL_BLENDMODE_NONE);
+        int blit = SDL_BlitSurface(imgs[i]->surf, NULL, ret->surf, region);
+        SDL_SetSurfaceBlendMode(imgs[i]->surf, blend_mode);
+        if (blit) {
+            PRINT_SDL_ERROR("Failed to copy image %u to atlas", i);
+            goto err_blit;
+        }
+        w += region->w + ATLAS_PADDING;
+    }
+
+    ret->tex = SDL_CreateTextureFromSurface(renderer, ret->surf);
+    if (ret->tex == NULL) {
+        PRINT_SDL_ERROR("Failed to create texture from atlas");
+        goto err_blit;
+    }
+
+    ret->w = ret->surf->w;
+    ret->h = ret->surf->h;
+    ret->scale = 1;
+    ret->regions_count = count;
+
+    pthread_mutex_lock(&loaded_images_lock);
+
+    loaded_image_t *iterator = &loaded_images_list;
+    for (; iterator->next; iterator = iterator->next)
+        ;
+    iterator->next = ret;
+
+    pthread_mutex_unlock(&loaded_images_lock);
+
+    return ret;
+
+err_blit:
+    SDL_FreeSurface(ret->surf);
+err_surf:
+    free(ret->regions);
+err_regions:
+    free(ret);
+err_alloc:
+    return NULL;
+}
+
+int tumDrawImageBatch(image_handle_t atlas, const unsigned regions[],
+                      const coord_t positions[], unsigned count)
+{
+    if (atlas == NULL || ((loaded_image_t *)atlas)->regions == NULL) {
+        return -1;
+    }
+
+    if (count == 0) {
+        return 0;
+    }
+
+    INIT_JOB(job, DRAW_IMAGE_BATCH);
+
+    job->data.image_batch.regions = jobAlloc(count * sizeof(unsigned));
+    job->data.image_batch.positions = jobAlloc(count * sizeof(coord_t));
+    if (job->data.image_batch.regions == NULL ||
+        job->data.image_batch.positions == NULL) {
+        logCriticalError("image batch alloc");
+    }
+
+    memcpy(job->data.image_batch.regions, regions, count * sizeof(unsigned));
+    memcpy(job->data.image_batch.positions, positions,
+           count * sizeof(coord_t));
+    ((loaded_image_t *)atlas)->ref_count++;
+    job->data.image_batch.atlas = atlas;
+    job->data.image_batch.count = count;
 
     return 0;
 }
@@ -1524,10 +2945,9 @@ int __attribute_deprecated__ tumDrawImage(char *filename, signed short x,
         return -1;
     }
 
-    job->data->image.filename = calloc(strlen(abs_path) + 1, sizeof(char));
-    strcpy(job->data->image.filename, abs_path);
-    job->data->image.x = x;
-    job->data->image.y = y;
+    job->data.image.filename = jobStrdup(abs_path);
+    job->data.image.x = x;
+    job->data.image.y = y;
 
     return 0;
 }
@@ -1550,12 +2970,10 @@ int __attribute_deprecated__ tumDrawScaledImage(char *filename, signed short x,
         return -1;
     }
 
-    job->data->scaled_image.image.filename =
-        calloc(strlen(abs_path) + 1, sizeof(char));
-    strcpy(job->data->scaled_image.image.filename, abs_path);
-    job->data->scaled_image.image.x = x;
-    job->data->scaled_image.image.y = y;
-    job->data->scaled_image.scale = scale;
+    job->data.scaled_image.image.filename = jobStrdup(abs_path);
+    job->data.scaled_image.image.x = x;
+    job->data.scaled_image.image.y = y;
+    job->data.scaled_image.scale = scale;
 
     return 0;
 }
@@ -1566,13 +2984,112 @@ int tumDrawArrow(signed short x1, signed short y1, signed short x2,
 {
     INIT_JOB(job, DRAW_ARROW);
 
-    job->data->arrow.x1 = x1;
-    job->data->arrow.y1 = y1;
-    job->data->arrow.x2 = x2;
-    job->data->arrow.y2 = y2;
-    job->data->arrow.head_length = head_length;
-    job->data->arrow.thickness = thickness;
-    job->data->arrow.colour = colour;
+    job->data.arrow.x1 = x1;
+    job->data.arrow.y1 = y1;
+    job->data.arrow.x2 = x2;
+    job->data.arrow.y2 = y2;
+    job->data.arrow.head_length = head_length;
+    job->data.arrow.thickness = thickness;
+    job->data.arrow.colour = colour;
+
+    return 0;
+}
+
+layer_handle_t tumDrawLayerCreate(int w, int h)
+{
+    if (w <= 0 || h <= 0) {
+        PRINT_ERROR("Layer size %d x %d is not valid", w, h);
+        return NULL;
+    }
+
+    layer_t *ret = calloc(1, sizeof(layer_t));
+    if (ret == NULL) {
+        PRINT_ERROR("Failed to allocate layer");
+        return NULL;
+    }
+
+    ret->w = w;
+    ret->h = h;
+
+    pthread_mutex_lock(&layers_lock);
+    ret->next = layers_list.next;
+    layers_list.next = ret;
+    pthread_mutex_unlock(&layers_lock);
+
+    return ret;
+}
+
+int tumDrawLayerFree(layer_handle_t *layer)
+{
+    layer_t **l = (layer_t **)layer;
+
+    if (*l == NULL) {
+        return -1;
+    }
+
+    // Hold a reference while marking the layer, so that exactly one put frees it
+    __atomic_add_fetch(&(*l)->ref_count, 1, __ATOMIC_ACQ_REL);
+    __atomic_store_n(&(*l)->pending_free, 1, __ATOMIC_RELEASE);
+    vPutLayer(*l);
+    *l = NULL;
+
+    return 0;
+}
+
+int tumDrawLayerBegin(layer_handle_t layer)
+{
+    if (layer == NULL) {
+        return -1;
+    }
+
+    INIT_JOB(job, DRAW_LAYER_BEGIN);
+
+    __atomic_add_fetch(&((layer_t *)layer)->ref_count, 1, __ATOMIC_ACQ_REL);
+    vSetLayerValid(layer, 1);
+    job->data.layer.layer = layer;
+
+    return 0;
+}
+
+int tumDrawLayerEnd(void)
+{
+    INIT_JOB(job, DRAW_LAYER_END);
+
+    return 0;
+}
+
+int tumDrawLayerInvalidate(layer_handle_t layer)
+{
+    if (layer == NULL) {
+        return -1;
+    }
+
+    vSetLayerValid(layer, 0);
+
+    return 0;
+}
+
+int tumDrawLayerIsValid(layer_handle_t layer)
+{
+    if (layer == NULL) {
+        return 0;
+    }
+
+    return __atomic_load_n(&((layer_t *)layer)->valid, __ATOMIC_ACQUIRE);
+}
+
+int tumDrawLayer(layer_handle_t layer, signed short x, signed short y)
+{
+    if (layer == NULL) {
+        return -1;
+    }
+
+    INIT_JOB(job, DRAW_LAYER);
+
+    __atomic_add_fetch(&((layer_t *)layer)->ref_count, 1, __ATOMIC_ACQ_REL);
+    job->data.layer.layer = layer;
+    job->data.layer.x = x;
+    job->data.layer.y = y;
 
     return 0;
 }
@@ -1605,44 +3122,44 @@ int tumDrawAnimationDrawFrame(sequence_handle_t sequence, unsigned ms_timestep,
     INIT_JOB(job, DRAW_LOADED_IMAGE_CROP);
 
     anim->image->spritesheet->image->ref_count++;
-    job->data->loaded_image_crop.image = anim->image->spritesheet->image;
-    job->data->loaded_image_crop.x = x;
-    job->data->loaded_image_crop.y = y;
-    job->data->loaded_image_crop.c_w =
+    job->data.loaded_image_crop.image = anim->image->spritesheet->image;
+    job->data.loaded_image_crop.x = x;
+    job->data.loaded_image_crop.y = y;
+    job->data.loaded_image_crop.c_w =
         anim->image->spritesheet->sprite_width;
-    job->data->loaded_image_crop.c_h =
+    job->data.loaded_image_crop.c_h =
         anim->image->spritesheet->sprite_height;
 
     switch (anim->sequence->direction) {
         case SPRITE_SEQUENCE_HORIZONTAL_POS:
-            job->data->loaded_image_crop.c_x =
+            job->data.loaded_image_crop.c_x =
                 (anim->current_frame + anim->sequence->start_col) *
                 anim->image->spritesheet->sprite_width;
-            job->data->loaded_image_crop.c_y =
+            job->data.loaded_image_crop.c_y =
                 anim->sequence->start_row *
                 anim->image->spritesheet->sprite_height;
             break;
         case SPRITE_SEQUENCE_HORIZONTAL_NEG:
-            job->data->loaded_image_crop.c_x =
+            job->data.loaded_image_crop.c_x =
                 (anim->sequence->start_col - anim->current_frame) *
                 anim->image->spritesheet->sprite_width;
-            job->data->loaded_image_crop.c_y =
+            job->data.loaded_image_crop.c_y =
                 anim->sequence->start_row *
                 anim->image->spritesheet->sprite_height;
             break;
         case SPRITE_SEQUENCY_VERTICAL_POS:
-            job->data->loaded_image_crop.c_x =
+            job->data.loaded_image_crop.c_x =
                 anim->sequence->start_col *
                 anim->image->spritesheet->sprite_height;
-            job->data->loaded_image_crop.c_y =
+            job->data.loaded_image_crop.c_y =
                 (anim->current_frame + anim->sequence->start_row) *
                 anim->image->spritesheet->sprite_width;
             break;
         case SPRITE_SEQUENCY_VERTICAL_NEG:
-            job->data->loaded_image_crop.c_x =
+            job->data.loaded_image_crop.c_x =
                 anim->sequence->start_col *
                 anim->image->spritesheet->sprite_height;
-            job->data->loaded_image_crop.c_y =
+            job->data.loaded_image_crop.c_y =
                 (anim->sequence->start_row - anim->current_frame) *
                 anim->image->spritesheet->sprite_width;
             break;
@@ -71,7 +71,14 @@ static void SDLFetchEvents(void)
     unsigned char send = 0;
 
     while (SDL_PollEvent(&event)) {
-        if ((event.type == SDL_QUIT) ||
+        // Window events only repaint an uncovered window, they are handled
+        // first as the Q check below would misread them as key events
+        if (event.type == SDL_WINDOWEVENT) {
+            if (event.window.event == SDL_WINDOWEVENT_EXPOSED) {
+                tumDrawInvalidateScreen();
+            }
+        }
+        else if ((event.type == SDL_QUIT) ||
             (event.key.keysym.scancode == SDL_SCANCODE_Q)) {
             exit(EXIT_SUCCESS);
         }
@@ -241,8 +248,8 @@ int tumEventInit(void)
         goto err_queue;
     }
 
-    // Ignore SDL events
-    SDL_EventState(SDL_WINDOWEVENT, SDL_IGNORE);
+    // Ignore SDL events, window events are only used to repaint the screen
+    SDL_EventState(SDL_WINDOWEVENT, SDL_ENABLE);
     SDL_EventState(SDL_TEXTINPUT, SDL_IGNORE);
     SDL_EventState(0x303, SDL_IGNORE);
 
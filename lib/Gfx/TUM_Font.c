@@ -32,10 +32,12 @@
     PRINT_ERROR("[TTF Error] %s\n" #msg, (char *)TTF_GetError(),           \
                 ##__VA_ARGS__)
 
+#define FONT_CACHE_BUCKETS 64
+#define FONT_CACHE_MAX_FONTS 32
+
 struct tum_font_ref {
     TTF_Font *font;
-    unsigned ref_count;
-    unsigned pending_free;
+    unsigned ref_count; // Accessed with __atomic builtins
 };
 
 typedef struct tum_font {
@@ -43,12 +45,21 @@ typedef struct tum_font {
     char *name;
     struct tum_font_ref font;
     unsigned size;
+    unsigned long key; // Hash of the name & size, see getFontKey()
+    unsigned pinned; // Loaded via tumFontLoadFont(), never evicted
+    unsigned long last_used;
     struct tum_font *next;
+    struct tum_font *bucket_next;
 } tum_font_t;
 
 pthread_mutex_t list_lock = PTHREAD_MUTEX_INITIALIZER;
 static struct tum_font font_list = { 0 };
 
+// Opened fonts by name & size, so changing the size reuses an opened font
+static struct tum_font *font_cache[FONT_CACHE_BUCKETS] = { 0 };
+static unsigned font_count = 0;
+static unsigned long font_clock = 0;
+
 static const char *fonts_dir;
 static struct tum_font *cur_default_font = NULL;
 
@@ -72,6 +83,17 @@ static char *getFontPath(char *font_name)
     return ret;
 }
 
+static unsigned long getFontKey(char *font_name, ssize_t size)
+{
+    unsigned long hash = 5381;
+
+    for (; *font_name; font_name++) {
+        hash = hash * 33 + (unsigned char)*font_name;
+    }
+
+    return hash * 33 + size;
+}
+
 static struct tum_font *tumFontCreateFont(char *font_name, ssize_t size)
 {
     struct tum_font *ret;
@@ -88,6 +110,7 @@ static struct tum_font *tumFontCreateFont(char *font_name, ssize_t size)
 
     ret->name = ret->path + strlen(fonts_dir);
     ret->size = size;
+    ret->key = getFontKey(ret->name, size);
 
     ret->font.font = TTF_OpenFont(ret->path, ret->size);
     if (ret->font.font == NULL) {
@@ -96,7 +119,6 @@ static struct tum_font *tumFontCreateFont(char *font_name, ssize_t size)
     }
 
     ret->font.ref_count = 0;
-    ret->font.pending_free = 0;
 
     return ret;
 
@@ -108,18 +130,17 @@ err_alloc_def_font:
     return NULL;
 }
 
-int tumFontInit(char *path)
+static struct tum_font *tumFontFindFont(char *font_name, ssize_t size)
 {
-    fonts_dir = tumUtilPrependPath(path, FONTS_DIR);
+    struct tum_font *iterator =
+        font_cache[getFontKey(font_name, size) % FONT_CACHE_BUCKETS];
 
-    font_list.next = tumFontCreateFont(DEFAULT_FONT, DEFAULT_FONT_SIZE);
-    if (font_list.next == NULL) {
-        return -1;
-    }
-
-    cur_default_font = font_list.next;
+    for (; iterator; iterator = iterator->bucket_next)
+        if (iterator->size == (unsigned)size && !strcmp(iterator->name, font_name)) {
+            return iterator;
+        }
 
-    return 0;
+    return NULL;
 }
 
 void tumFontDeleteFont(struct tum_font *font)
@@ -129,6 +150,93 @@ void tumFontDeleteFont(struct tum_font *font)
     free(font);
 }
 
+static void tumFontRemoveFont(struct tum_font *font)
+{
+    struct tum_font *iterator = &font_list;
+    struct tum_font **bucket = &font_cache[font->key % FONT_CACHE_BUCKETS];
+
+    for (; iterator->next; iterator = iterator->next)
+        if (iterator->next == font) {
+            iterator->next = font->next;
+            break;
+        }
+
+    for (; *bucket; bucket = &(*bucket)->bucket_next)
+        if (*bucket == font) {
+            *bucket = font->bucket_next;
+            break;
+        }
+
+    font_count--;
+    tumFontDeleteFont(font);
+}
+
+static void tumFontEvictFonts(void)
+{
+    while (font_count >= FONT_CACHE_MAX_FONTS) {
+        struct tum_font *iterator = font_list.next;
+        struct tum_font *oldest = NULL;
+
+        for (; iterator; iterator = iterator->next)
+            if (!__atomic_load_n(&iterator->font.ref_count,
+                                 __ATOMIC_ACQUIRE) &&
+                !iterator->pinned &&
+                iterator != cur_default_font &&
+                (!oldest || iterator->last_used < oldest->last_used)) {
+                oldest = iterator;
+            }
+
+        // Pinned fonts & fonts still referenced by pending text are kept
+        if (oldest == NULL) {
+            return;
+        }
+
+        tumFontRemoveFont(oldest);
+    }
+}
+
+static struct tum_font *tumFontAppendFont(char *font_name, ssize_t size)
+{
+    struct tum_font *iterator = tumFontFindFont(font_name, size);
+
+    if (iterator) {
+        return iterator;
+    }
+
+    tumFontEvictFonts();
+
+    struct tum_font *font = tumFontCreateFont(font_name, size);
+    if (font == NULL) {
+        return NULL;
+    }
+
+    for (iterator = &font_list; iterator->next; iterator = iterator->next)
+        ;
+
+    iterator->next = font;
+
+    unsigned bucket = font->key % FONT_CACHE_BUCKETS;
+    font->bucket_next = font_cache[bucket];
+    font_cache[bucket] = font;
+    font_count++;
+
+    return font;
+}
+
+int tumFontInit(char *path)
+{
+    fonts_dir = tumUtilPrependPath(path, FONTS_DIR);
+
+    cur_default_font = tumFontAppendFont(DEFAULT_FONT, DEFAULT_FONT_SIZE);
+    if (cur_default_font == NULL) {
+        return -1;
+    }
+
+    cur_default_font->pinned = 1;
+
+    return 0;
+}
+
 void tumFontExit(void)
 {
     pthread_mutex_lock(&list_lock);
@@ -142,64 +250,43 @@ void tumFontExit(void)
         tumFontDeleteFont(delete);
     }
 
+    font_list.next = NULL;
+    memset(font_cache, 0, sizeof(font_cache));
+    font_count = 0;
+    cur_default_font = NULL;
+
     pthread_mutex_unlock(&list_lock);
 }
 
 void tumFontPutFontHandle(font_handle_t font)
 {
-    pthread_mutex_lock(&list_lock);
-    struct tum_font *iterator = &font_list;
-    struct tum_font *delete = NULL;
+    // Fonts are only closed while holding the lock & without references
+    if (font) {
+        __atomic_sub_fetch(&((struct tum_font *)font)->font.ref_count, 1,
+                           __ATOMIC_RELEASE);
+    }
+}
 
-    for (; iterator; iterator = iterator->next) {
-        if (iterator == font) {
-            iterator->font.ref_count--;
-            if (iterator->font.ref_count == 0 &&
-                iterator->font.pending_free) {
-                if (iterator->next) {
-                    if (delete) {
-                        delete->next = iterator->next;
-                    }
-                    else {
-                        font_list.next = iterator->next;
-                    }
-                }
-                tumFontDeleteFont(iterator);
-            }
-            pthread_mutex_unlock(&list_lock);
-            return;
-        }
-        delete = iterator;
+TTF_Font *tumFontGetFontFromHandle(font_handle_t font_handle)
+{
+    if (font_handle == NULL) {
+        return NULL;
     }
-    pthread_mutex_unlock(&list_lock);
 
+    return ((struct tum_font *)font_handle)->font.font;
 }
 
 void tumFontPutFont(TTF_Font *font)
 {
     pthread_mutex_lock(&list_lock);
-    struct tum_font *iterator = &font_list;
-    struct tum_font *delete = NULL;
+    struct tum_font *iterator = font_list.next;
 
     for (; iterator; iterator = iterator->next) {
         if (iterator->font.font == font) {
-            iterator->font.ref_count--;
-            if (iterator->font.ref_count == 0 &&
-                iterator->font.pending_free) {
-                if (iterator->next) {
-                    if (delete) {
-                        delete->next = iterator->next;
-                    }
-                    else {
-                        font_list.next = iterator->next;
-                    }
-                }
-                tumFontDeleteFont(iterator);
-            }
+            __atomic_sub_fetch(&iterator->font.ref_count, 1, __ATOMIC_RELEASE);
             pthread_mutex_unlock(&list_lock);
             return;
         }
-        delete = iterator;
     }
     pthread_mutex_unlock(&list_lock);
 }
@@ -210,7 +297,8 @@ TTF_Font *tumFontGetCurFont(void)
 
     pthread_mutex_lock(&list_lock);
 
-    cur_default_font->font.ref_count++;
+    __atomic_add_fetch(&cur_default_font->font.ref_count, 1,
+                       __ATOMIC_ACQUIRE);
     ret = cur_default_font->font.font;
 
     pthread_mutex_unlock(&list_lock);
@@ -234,28 +322,22 @@ char *tumFontGetCurFontName(void)
     return ret;
 }
 
-font_handle_t tumFontGetCurFontHandle(void)
+unsigned long tumFontGetCurFontKey(void)
 {
     pthread_mutex_lock(&list_lock);
-    cur_default_font->font.ref_count++;
-    font_handle_t ret = cur_default_font;
+    unsigned long ret = cur_default_font->key;
     pthread_mutex_unlock(&list_lock);
     return ret;
 }
 
-static struct tum_font *tumFontAppendFont(char *font_name, ssize_t size)
+font_handle_t tumFontGetCurFontHandle(void)
 {
-    struct tum_font *iterator = &font_list;
-
-    for (; iterator->next; iterator = iterator->next)
-        ;
-
-    iterator->next = tumFontCreateFont(font_name, size);
-    if (iterator->next == NULL) {
-        return NULL;
-    }
-
-    return iterator->next;
+    pthread_mutex_lock(&list_lock);
+    __atomic_add_fetch(&cur_default_font->font.ref_count, 1,
+                       __ATOMIC_ACQUIRE);
+    font_handle_t ret = cur_default_font;
+    pthread_mutex_unlock(&list_lock);
+    return ret;
 }
 
 int tumFontLoadFont(char *font_name, ssize_t size)
@@ -264,10 +346,14 @@ int tumFontLoadFont(char *font_name, ssize_t size)
 
     pthread_mutex_lock(&list_lock);
 
-    if (tumFontAppendFont(font_name, (size) ? size : DEFAULT_FONT_SIZE) ==
-        NULL) {
+    struct tum_font *font =
+        tumFontAppendFont(font_name, (size) ? size : DEFAULT_FONT_SIZE);
+    if (font == NULL) {
         ret = -1;
     }
+    else {
+        font->pinned = 1;
+    }
 
     pthread_mutex_unlock(&list_lock);
 
@@ -283,6 +369,7 @@ int tumFontSelectFontFromName(char *font_name)
         if (iterator->name)
             if (!strcmp(iterator->name, font_name)) {
                 cur_default_font = iterator;
+                cur_default_font->last_used = ++font_clock;
                 pthread_mutex_unlock(&list_lock);
                 return 0;
             }
@@ -300,6 +387,7 @@ int tumFontSelectFontFromHandle(font_handle_t font_handle)
     for (; iterator; iterator = iterator->next)
         if (iterator == font_handle) {
             cur_default_font = iterator;
+            cur_default_font->last_used = ++font_clock;
             pthread_mutex_unlock(&list_lock);
             return 0;
         }
@@ -312,7 +400,7 @@ int tumFontSelectFontFromHandle(font_handle_t font_handle)
 int tumFontSetSize(ssize_t font_size)
 {
     if (cur_default_font == NULL) {
-        goto err_;
+        return -1;
     }
 
     pthread_mutex_lock(&list_lock);
@@ -322,27 +410,16 @@ int tumFontSetSize(ssize_t font_size)
         return 0;
     }
 
-    if (!cur_default_font->font.ref_count) {
-        TTF_CloseFont(cur_default_font->font.font);
-        TTF_Font *new_font =
-            TTF_OpenFont(cur_default_font->path, font_size);
-
-        if (new_font == NULL) {
-            goto err_;
-        }
-
-        cur_default_font->font.font = new_font;
-        cur_default_font->size = font_size;
-    }
-    else {
-        cur_default_font->font.pending_free = 1;
-        cur_default_font =
-            tumFontAppendFont(cur_default_font->name, font_size);
-        if (!cur_default_font) {
-            goto err_;
-        }
+    // Opened fonts stay open, pending text keeps drawing with its own size
+    struct tum_font *font =
+        tumFontAppendFont(cur_default_font->name, font_size);
+    if (font == NULL) {
+        goto err_;
     }
 
+    cur_default_font = font;
+    cur_default_font->last_used = ++font_clock;
+
     pthread_mutex_unlock(&list_lock);
 
     return 0;
@@ -72,6 +72,20 @@
 #define SCREEN_HEIGHT 480
 #endif //SCREEN_HEIGHT
 
+/**
+ * Environment variable that selects the backend used by tumDrawInit(). If it
+ * is set to TUM_DRAW_BACKEND_SOFTWARE, no window is opened and frames are
+ * rendered by the SDL software renderer into an offscreen surface, e.g. to
+ * measure the cost of drawing on machines without a display. Otherwise the
+ * frames are rendered into a window.
+ */
+#define TUM_DRAW_BACKEND_ENV "TUM_DRAW_BACKEND"
+
+/**
+ * Value of TUM_DRAW_BACKEND_ENV that selects the offscreen software renderer
+ */
+#define TUM_DRAW_BACKEND_SOFTWARE "software"
+
 /**
  * @name Hex RGB colours
  *
@@ -149,6 +163,17 @@ typedef void *animation_handle_t;
  */
 typedef void *sequence_handle_t;
 
+/**
+ * @brief Handle used to reference a layer, an invalid layer will have a NULL
+ * handle
+ *
+ * A layer is a texture that drawing can be redirected to, see
+ * tumDrawLayerBegin(). It keeps its contents across frames, so parts of a scene
+ * that rarely change only need to be drawn once and can then be drawn to the
+ * screen each frame with a single tumDrawLayer().
+ */
+typedef void *layer_handle_t;
+
 /**
  * @brief Returns a string error message from the TUM Draw back end
  *
@@ -180,15 +205,32 @@ int tumDrawBindThread(void);
 void tumDrawExit(void);
 
 /**
- * @brief Executes the queued draw jobs
+ * @brief Marks the draw jobs queued since the last call as a complete frame
+ *
+ * The queued jobs are handed over to tumDrawUpdateScreen() in one step, so
+ * the next frame can be queued while the previous one is being drawn. If the
+ * previously submitted frame has not been drawn yet, it is dropped in favour
+ * of the new one. Layers drawn by the dropped frame are drawn at the start of
+ * the new frame instead, unless the new frame draws them as well.
+ *
+ * @return 0 on success
+ */
+int tumDrawSubmitFrame(void);
+
+/**
+ * @brief Executes the draw jobs of the last submitted frame
  *
- * The tumDraw primative draw functions are designed to be callable from any
- * thread, as such each function queues a draw job into a queue. Once
- * tumDrawUpdateScreen is called, the queued draw jobs are executed by the
- * background SDL thread.
+ * The tumDraw primative draw functions queue a draw job each, without taking
+ * a lock, so a frame must be queued & submitted by one thread at a time. Once
+ * the frame is submitted with tumDrawSubmitFrame() & tumDrawUpdateScreen is
+ * called, the queued draw jobs are executed by the background SDL thread.
+ * If no new frame was submitted, nothing is drawn & 1 is returned. The same
+ * happens if tumDrawSubmitFrame() is swapping frames at that moment, the
+ * frame is then drawn by the next call. Only the region that changed since
+ * the last frame is drawn again & a frame that changes nothing on the screen
+ * is not presented, 1 is returned for it as well.
  *
- * While primitive drawing functions, such as tumDrawCircle(), are thread-safe
- * calls to tumDrawUpdateScreen() must come from the thread that holds the GL
+ * Calls to tumDrawUpdateScreen() must come from the thread that holds the GL
  * (graphics layer) context. A thread can obtain the GL context by calling
  * tumDrawBindThread(). Please be wary that tumDrawBindThread() has a large
  * overhead and should be avoided when possible. Having a centeralized screen
@@ -196,10 +238,17 @@ void tumDrawExit(void);
  * dependent calls, such as tumDrawUpdateScreen() will fail if the calling
  * thread does not hold the GL context.
  *
- * @returns 0 on success
+ * @returns 0 if a new frame was presented, 1 if the screen is unchanged & -1
+ * on error
  */
 int tumDrawUpdateScreen(void);
 
+/**
+ * @brief Draws & presents the whole screen with the next frame, e.g. after
+ * the window was covered & is shown again
+ */
+void tumDrawInvalidateScreen(void);
+
 /**
  * @brief Sets the screen to a solid colour
  *
@@ -436,6 +485,37 @@ int tumDrawGetLoadedImageSize(image_handle_t img, int *w, int *h);
  */
 int tumDrawLoadedImage(image_handle_t img, signed short x, signed short y);
 
+/**
+ * @brief Packs loaded images into a single new image, an atlas, which can be
+ * freed using tumDrawFreeLoadedImage()
+ *
+ * The images are placed next to each other, image i becomes region i of the
+ * atlas. The atlas does not depend on the given images, they can be freed
+ * afterwards. Regions of the atlas are drawn with tumDrawImageBatch(), so that
+ * many images are drawn with a single texture and renderer call.
+ *
+ * @param images Array of handles to the loaded images to be packed
+ * @param count Number of images in the images array
+ * @return Returns a image_handle_t handle to the atlas
+ */
+image_handle_t tumDrawCreateAtlas(image_handle_t images[], unsigned count);
+
+/**
+ * @brief Draws many regions of an atlas to the screen as a single batch
+ *
+ * All quads are submitted with one SDL_RenderGeometry() call, so the texture
+ * is only bound once and the renderer state does not change between them.
+ * Regions are drawn with the scale of the atlas.
+ *
+ * @param atlas Handle to an atlas created by tumDrawCreateAtlas()
+ * @param regions Array giving the region of the atlas to draw for each quad
+ * @param positions Array giving the top left corner of each quad
+ * @param count Number of quads
+ * @return 0 on success
+ */
+int tumDrawImageBatch(image_handle_t atlas, const unsigned regions[],
+                      const coord_t positions[], unsigned count);
+
 /**
  * @brief Draws an image on the screen
  *
@@ -554,6 +634,74 @@ sequence_handle_t tumDrawAnimationSequenceInstantiate(animation_handle_t animati
 int tumDrawAnimationDrawFrame(sequence_handle_t sequence, unsigned ms_timestep,
                               int x, int y);
 
+/**
+ * @brief Creates a layer, which can be freed using tumDrawLayerFree()
+ *
+ * The layer's texture is created by the drawing thread, the first time the
+ * layer is drawn to.
+ *
+ * @param w Width of the layer in pixels
+ * @param h Height of the layer in pixels
+ * @return Returns a layer_handle_t handle to the layer
+ */
+layer_handle_t tumDrawLayerCreate(int w, int h);
+
+/**
+ * @brief Frees a layer and its texture, once no pending draw jobs use it
+ *
+ * @param layer Handle to the layer, set to NULL once freed
+ * @return 0 on success
+ */
+int tumDrawLayerFree(layer_handle_t *layer);
+
+/**
+ * @brief Redirects all following drawing to the layer, until tumDrawLayerEnd()
+ *
+ * The layer is cleared to transparent first and is valid afterwards, see
+ * tumDrawLayerIsValid(). Layers cannot be nested.
+ *
+ * @param layer Handle to the layer
+ * @return 0 on success
+ */
+int tumDrawLayerBegin(layer_handle_t layer);
+
+/**
+ * @brief Redirects all following drawing back to the screen
+ *
+ * @return 0 on success
+ */
+int tumDrawLayerEnd(void);
+
+/**
+ * @brief Marks the contents of a layer as outdated, so that they are drawn again
+ *
+ * @param layer Handle to the layer
+ * @return 0 on success
+ */
+int tumDrawLayerInvalidate(layer_handle_t layer);
+
+/**
+ * @brief Checks if the contents of a layer are up to date
+ *
+ * A layer is valid after tumDrawLayerBegin(), until it is invalidated with
+ * tumDrawLayerInvalidate() or its texture is lost because the renderer was
+ * recreated by tumDrawBindThread().
+ *
+ * @param layer Handle to the layer
+ * @return 1 if the layer is valid, 0 otherwise
+ */
+int tumDrawLayerIsValid(layer_handle_t layer);
+
+/**
+ * @brief Draws the contents of a layer to the screen
+ *
+ * @param layer Handle to the layer
+ * @param x X coordinate of the top left corner of the layer
+ * @param y Y coordinate of the top left corner of the layer
+ * @return 0 on success
+ */
+int tumDrawLayer(layer_handle_t layer, signed short x, signed short y);
+
 /**
  * @brief Sets the global draw position offset's X axis value
  *
@@ -84,7 +84,8 @@ typedef void *font_handle_t;
 
 /**
  * @brief Loads a font with the given font name from the FONTS_DIRECTORY
- * directory, by default this is in `resources/fonts`
+ * directory, by default this is in `resources/fonts`. Loaded fonts stay open
+ * until tumFontExit() is called.
  *
  * @param font_name A string representation of the fonts filename, including
  * suffix (.ttf)
@@ -124,24 +125,31 @@ TTF_Font *tumFontGetCurFont(void);
 
 /**
  * @brief Finds the tum_font object associated with the loaded SDL2 TFF font,
- * decreasing the reference count to the object with each call, once an object's
- * reference count has reached zero and the font backed has flagged the tum_font
- * object as no longer being needed it is then free'd.
+ * decreasing the reference count to the object with each call. Fonts without
+ * references can be closed once the font cache is full.
  *
  * @param font SDL2 TTF font reference, retrieved originally via tumFontGetCurFont()
  */
 void tumFontPutFont(TTF_Font *font);
 
 /**
- * @brief Finds the tum_font object associated with the loaded SDL2 TFF font,
- * decreasing the reference count to the object with each call, once an object's
- * reference count has reached zero and the font backed has flagged the tum_font
- * object as no longer being needed it is then free'd.
+ * @brief Decreases the reference count of the font handle. Unlike
+ * tumFontPutFont() no lock is taken, so the drawing thread can put its
+ * references without waiting for a task holding the font lock.
  *
  * @param font Font handle, retrieved originally via tumFontGetCurFontHandle()
  */
 void tumFontPutFontHandle(font_handle_t font);
 
+/**
+ * @brief Returns the SDL2 TTF font of a font handle, without taking another
+ * reference. The font stays open as long as the handle's reference is held.
+ *
+ * @param font_handle Handle retrieved originally using tumFontGetCurFontHandle()
+ * @return The SDL2 TTF font of the handle
+ */
+TTF_Font *tumFontGetFontFromHandle(font_handle_t font_handle);
+
 /**
  * @brief Retrieved a handle to the current font, unlike tumFontGetCurFont()
  * the handle contains the TUM_Font's metadata structure for the font instance
@@ -166,6 +174,14 @@ ssize_t tumFontGetCurFontSize(void);
  */
 char *tumFontGetCurFontName(void);
 
+/**
+ * @brief Returns a key identifying the currently active font and size, without
+ * allocating any memory. Equal fonts and sizes always give the same key.
+ *
+ * @return Hash of the name and size of the currently active font
+ */
+unsigned long tumFontGetCurFontKey(void);
+
 /**
  * @brief Sets the active font from a string of the font's filename. The filename
  * is not the absolute file but the font's name within the FONT_DIRECTORY
@@ -186,11 +202,13 @@ int tumFontSelectFontFromName(char *font_name);
 int tumFontSelectFontFromHandle(font_handle_t font_handle);
 
 /**
- * @brief Sets the size of the current font to be used. The font is set by making
- * a copy of the current font if the current font's configuration (font + size)
- * is being referenced by pending draw jobs. All subsequent text draw jobs
- * will use the currently active font and the specified size until the size
- * and/or font are changed again.
+ * @brief Sets the size of the current font to be used. Each configuration
+ * (font + size) is opened once and kept in a cache, so switching back to a
+ * size that was used before does not load the font again. The least recently
+ * used configurations that are not referenced by pending draw jobs nor loaded
+ * via tumFontLoadFont() are closed once the cache is full. All subsequent text
+ * draw jobs will use the currently active font and the specified size until
+ * the size and/or font are changed again.
  *
  * @param font_size New size that the currently active font should take
  * @return 0 on success
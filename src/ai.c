@@ -0,0 +1,655 @@
+#include "ai.h"
+#include <stddef.h>
+
+/**
+ * @ingroup ai
+ * @brief Maximum number of inputs for one Tetromino, before it is dropped where it is.
+ */
+#define MAX_MOVES (NUMBER_OF_ROTATIONS + COLS + FIGURE_SIZE)
+
+/**
+ * @ingroup ai
+ * @brief Maximum length of a line in a weights file.
+ */
+#define MAX_LINE 64
+
+/**
+ * @ingroup ai
+ * @brief Name of a weight in the weights files & its offset in @ref ai_weights_t.
+ */
+typedef struct weight_name
+{
+    const char *name;   ///< Name of the weight
+    size_t offset;      ///< Offset of the weight in @ref ai_weights_t
+} weight_name_t;
+
+/**
+ * @ingroup ai
+ * @brief Names of all weights, in the order of @ref ai_weights_t.
+ */
+static const weight_name_t weightNames[AI_WEIGHTS] = {
+    { "height",             offsetof(ai_weights_t, height) },
+    { "holes",              offsetof(ai_weights_t, holes) },
+    { "bumpiness",          offsetof(ai_weights_t, bumpiness) },
+    { "rows",               offsetof(ai_weights_t, rows) },
+    { "rowTransitions",     offsetof(ai_weights_t, rowTransitions) },
+    { "columnTransitions",  offsetof(ai_weights_t, columnTransitions) },
+};
+
+/**
+ * @ingroup ai
+ * @brief Board reached by placing one or more Tetrominos.
+ */
+typedef struct ai_node
+{
+    board_t board;          ///< The board after all placements
+    uint16_t rows;          ///< Number of rows cleared on the way
+    float rating;           ///< Rating of the board, see fAIEvaluate()
+    placement_t first;      ///< Placement of the current Tetromino, that leads to this board
+} ai_node_t;
+
+struct ai_search
+{
+    thread_pool_t *pool;    ///< Thread pool to expand the boards on, may be NULL
+    int width;              ///< Number of boards kept per level
+    int depth;              ///< Number of Tetrominos placed
+    uint32_t budget;        ///< Time budget of one search in ms, 0 for no limit
+
+    ai_node_t *beam;        ///< Boards of the last complete level
+    int beamSize;           ///< Number of boards in the beam
+    ai_node_t *children;    ///< #MAX_PLACEMENTS children for each board of the beam
+    int *childCount;        ///< Number of children of each board, -1 if it was not expanded in time
+    ai_node_t **ranking;    ///< All children, sorted by their rating
+    float *leafRatings;     ///< On the last level, the best rating of each board of the beam
+    trans_table_t *table;   ///< Best ratings of boards on the last level, keyed by the board & the Tetromino
+    ai_weights_t tableWeights;      ///< Weights the ratings in the table were computed with
+    rotation_t tableRotation;       ///< Rotation mode the ratings in the table were computed with
+
+    // Arguments of the current level
+    tetromino_t piece;              ///< Tetromino placed on this level
+    bool root;                      ///< Whether the current Tetromino is placed on this level
+    bool last;                      ///< Whether this is the last level, that only rates the boards
+    rotation_t rotationMode;        ///< Rotation mode of the game
+    const ai_weights_t *weights;    ///< Weights of the board evaluation
+    uint64_t deadline;              ///< Time, when the search has to stop, in µs, 0 for no limit
+};
+
+// **********************************************************************************
+// Forward Declarations *************************************************************
+// **********************************************************************************
+/**
+ * @ingroup ai
+ * @brief Get the current time of a monotonic clock.
+ * @return (uint64_t): Time in µs.
+ */
+static uint64_t now(void);
+
+/**
+ * @ingroup ai
+ * @brief Play the inputs of xAIGetInput() for a placement: rotate, then move column by column & finally drop.
+ * @param[in] tetromino (const @ref tetromino_t *): Tetromino to place, at its current position.
+ * @param[in] placement (const @ref placement_t *): The placement.
+ * @param[in] landed (const @ref board_t *): Board of landed Tetrominos.
+ * @param[in] rotationMode ( @ref rotation_t): Rotation mode, either left or right.
+ * @param[in] gravity (bool): Whether the Tetromino falls by one row after each input.
+ * @return (bool): Whether the Tetromino is dropped onto the placement.
+ */
+static bool followPath( const tetromino_t *tetromino,
+                        const placement_t *placement,
+                        const board_t *landed,
+                        rotation_t rotationMode,
+                        bool gravity);
+
+/**
+ * @ingroup ai
+ * @brief Check if a placement is reached by the inputs of xAIGetInput(), see followPath().
+ * 
+ * Gravity pulls the Tetromino down by at most one row per input, 
+ * so the path is checked without gravity & with a fall after every input.
+ * Placements below overhangs are returned by iLogicGetPlacements() as well, but cannot be reached this way.
+ * @param[in] tetromino (const @ref tetromino_t *): Tetromino to place, at its current position.
+ * @param[in] placement (const @ref placement_t *): The placement.
+ * @param[in] landed (const @ref board_t *): Board of landed Tetrominos.
+ * @param[in] rotationMode ( @ref rotation_t): Rotation mode, either left or right.
+ * @return (bool): Whether the placement is reached.
+ */
+static bool isReachable(const tetromino_t *tetromino, const placement_t *placement, const board_t *landed, rotation_t rotationMode);
+
+/**
+ * @ingroup ai
+ * @brief Try each placement on a copy of the board & rate the resulting boards,
+ * #EVALUATE_BATCH boards at a time.
+ * @param[in] tetromino (const @ref tetromino_t *): Tetromino to place.
+ * @param[in] landed (const @ref board_t *): Board of landed Tetrominos.
+ * @param[in] placements (const @ref placement_t []): The placements.
+ * @param[in] count (int): Number of placements.
+ * @param[in] weights (const @ref ai_weights_t *): Weights of the board evaluation.
+ * @param[out] ratings (float []): Rating of each placement.
+ */
+static void ratePlacements( const tetromino_t *tetromino,
+                            const board_t *landed,
+                            const placement_t placements[],
+                            int count,
+                            const ai_weights_t *weights,
+                            float ratings[]);
+
+/**
+ * @ingroup ai
+ * @brief Remove the placements, that xAIGetInput() cannot reach, see isReachable().
+ * @param[in] tetromino (const @ref tetromino_t *): Tetromino to place, at its current position.
+ * @param[in] landed (const @ref board_t *): Board of landed Tetrominos.
+ * @param[in] rotationMode ( @ref rotation_t): Rotation mode, either left or right.
+ * @param[inout] placements ( @ref placement_t []): The placements, the reachable ones are moved to the front.
+ * @param[in] count (int): Number of placements.
+ * @return (int): Number of reachable placements.
+ */
+static int filterReachable(const tetromino_t *tetromino, const board_t *landed, rotation_t rotationMode, placement_t placements[], int count);
+
+/**
+ * @ingroup ai
+ * @brief Get the key of a board & a Tetromino in the transposition table.
+ * @param[in] landed (const @ref board_t *): The board.
+ * @param[in] tetromino (const @ref tetromino_t *): Tetromino placed on the board, at its spawn position.
+ * @return (uint64_t): The key.
+ */
+static uint64_t tableKey(const board_t *landed, const tetromino_t *tetromino);
+
+/**
+ * @ingroup ai
+ * @brief Get the best rating of placing the Tetromino of the last level on one board of the beam.
+ * 
+ * The rows cleared before the last level are not included in the rating,
+ * so that it only depends on the board & the Tetromino & can be cached in the transposition table.
+ * @param[inout] search ( @ref ai_search_t *): The search.
+ * @param[in] landed (const @ref board_t *): The board.
+ * @param[out] rating (float *): The best rating.
+ * @return (bool): false if the Tetromino cannot be placed anywhere.
+ */
+static bool rateLeaf(ai_search_t *search, const board_t *landed, float *rating);
+
+/**
+ * @ingroup ai
+ * @brief Place the Tetromino of the current level on one board of the beam in all possible ways,
+ * used as @ref pool_job_t.
+ * @param[in] index (int): Index of the board in the beam.
+ * @param[in] worker (int): Index of the worker (unused).
+ * @param[in] args (void*): The @ref ai_search_t.
+ */
+static void expandNode(int index, int worker, void *args);
+
+/**
+ * @ingroup ai
+ * @brief Compare the ratings of two nodes for qsort(), the better one first.
+ * @param[in] a (const void*): Pointer to the first @ref ai_node_t *.
+ * @param[in] b (const void*): Pointer to the second @ref ai_node_t *.
+ * @return (int): Negative, 0 or positive, if the first rating is higher, equal or lower.
+ */
+static int compareNodes(const void *a, const void *b);
+
+// **********************************************************************************
+// Function Definitions *************************************************************
+// **********************************************************************************
+void vAIInit(ai_player_t *ai, const ai_weights_t *weights, ai_search_t *search)
+{
+    *ai = (ai_player_t){ 0 };
+    ai->weights = weights ? *weights : AI_DEFAULT_WEIGHTS;
+    ai->search = search;
+}
+
+bool bAILoadWeights(const char *path, ai_weights_t *weights)
+{
+    FILE *file = fopen(path, "r");
+    if(!file)
+        return false;
+
+    char line[MAX_LINE];
+    while(fgets(line, sizeof line, file))
+    {
+        char name[MAX_LINE];
+        float value;
+        if(line[0] == '#' || sscanf(line, "%63s", name) != 1)
+            continue;
+        if(sscanf(line, "%63s %f", name, &value) != 2)
+            goto err_line;
+
+        size_t i = 0;
+        while(i < AI_WEIGHTS && strcmp(name, weightNames[i].name))
+            i++;
+        if(i == AI_WEIGHTS)
+            goto err_line;
+        memcpy((char*)weights + weightNames[i].offset, &value, sizeof value);
+    }
+    fclose(file);
+    return true;
+
+    err_line:
+        PRINT_ERROR("Invalid line in %s: %s", path, line);
+        fclose(file);
+        return false;
+}
+
+bool bAISaveWeights(const char *path, const ai_weights_t *weights)
+{
+    FILE *file = fopen(path, "w");
+    if(!file)
+        return false;
+
+    fprintf(file, "# Weights of the AI's board evaluation, see ai_weights_t\n");
+    for(size_t i=0; i<AI_WEIGHTS; i++)
+    {
+        float value;
+        memcpy(&value, (const char*)weights + weightNames[i].offset, sizeof value);
+        fprintf(file, "%s %.9g\n", weightNames[i].name, value);
+    }
+    return !fclose(file);
+}
+
+float fAIEvaluate(const board_features_t *features, int rows, const ai_weights_t *weights)
+{
+    return  weights->height * features->height +
+            weights->holes * features->holes +
+            weights->bumpiness * features->bumpiness +
+            weights->rows * rows +
+            weights->rowTransitions * features->rowTransitions +
+            weights->columnTransitions * features->columnTransitions;
+}
+
+bool bAIFindPlacement(  const tetromino_t *tetromino,
+                        const board_t *landed,
+                        rotation_t rotationMode,
+                        const ai_weights_t *weights,
+                        placement_t *best)
+{
+    placement_t placements[MAX_PLACEMENTS];
+    float ratings[MAX_PLACEMENTS];
+    int count = iLogicGetPlacements(tetromino, landed, rotationMode, placements, MAX_PLACEMENTS);
+    count = filterReachable(tetromino, landed, rotationMode, placements, count);
+    ratePlacements(tetromino, landed, placements, count, weights, ratings);
+
+    float bestRating = 0;
+    for(int i=0; i<count; i++)
+        if(i == 0 || ratings[i] > bestRating)
+        {
+            bestRating = ratings[i];
+            *best = placements[i];
+        }
+    return count > 0;
+}
+
+ai_search_t *pxAISearchCreate(int width, int depth, uint32_t budget, thread_pool_t *pool)
+{
+    if(width < 1 || depth < 1)
+        return NULL;
+
+    ai_search_t *search = calloc(1, sizeof *search);
+    if(!search)
+        goto err_search;
+    search->pool = pool;
+    search->width = width;
+    search->depth = depth > AI_MAX_DEPTH ? AI_MAX_DEPTH : depth;
+    search->budget = budget;
+
+    search->beam = calloc(width, sizeof *search->beam);
+    if(!search->beam)
+        goto err_beam;
+    search->children = calloc(width * MAX_PLACEMENTS, sizeof *search->children);
+    if(!search->children)
+        goto err_children;
+    search->childCount = calloc(width, sizeof *search->childCount);
+    if(!search->childCount)
+        goto err_child_count;
+    search->ranking = calloc(width * MAX_PLACEMENTS, sizeof *search->ranking);
+    if(!search->ranking)
+        goto err_ranking;
+    search->leafRatings = calloc(width, sizeof *search->leafRatings);
+    if(!search->leafRatings)
+        goto err_leaf_ratings;
+    search->table = pxTransTableCreate(AI_TABLE_BITS);
+    if(!search->table)
+        goto err_table;
+
+    return search;
+
+    err_table:
+        free(search->leafRatings);
+    err_leaf_ratings:
+        free(search->ranking);
+    err_ranking:
+        free(search->childCount);
+    err_child_count:
+        free(search->children);
+    err_children:
+        free(search->beam);
+    err_beam:
+        free(search);
+    err_search:
+        return NULL;
+}
+
+void vAISearchDelete(ai_search_t *search)
+{
+    if(!search)
+        return;
+    vTransTableDelete(search->table);
+    free(search->leafRatings);
+    free(search->ranking);
+    free(search->childCount);
+    free(search->children);
+    free(search->beam);
+    free(search);
+}
+
+bool bAISearch( ai_search_t *search,
+                const game_state_t *state,
+                const ai_weights_t *weights,
+                placement_t *best)
+{
+    // Upcoming Tetrominos **********************************************************
+    // The spawn rotations are predicted from copies of the game's generator & bag,
+    // in the same order lockTetromino() of the engine initializes the Tetrominos.
+    tetromino_t pieces[AI_MAX_DEPTH] = { state->current, state->next };
+    int depth = search->depth < 2 ? search->depth : 2;
+    rng_t rng = state->rng;
+    bag_t bag = state->bag;
+    while(depth < search->depth)
+    {
+        // In multiplayer mode, only the type pending from the opponent is known
+        tetromino_t *piece = &pieces[depth];
+        piece->type = (state->playerMode == MULTI_PLAYER && depth == 2) ? state->pendingType : NO_TYPE;
+        vLogicInitTetromino(piece, &bag, state->playerMode, &rng);
+        if(piece->type == NO_TYPE)
+            break;
+        depth++;
+    }
+
+    // Limit the budget, so that the search finishes before the Tetromino falls
+    uint32_t budget = search->budget;
+    if(budget && budget > state->gravityPeriod / 2)
+        budget = state->gravityPeriod / 2;
+    search->deadline = budget ? now() + budget * 1000 : 0;
+    search->rotationMode = state->rotationMode;
+    search->weights = weights;
+
+    // The cached ratings are only valid for the same weights & rotation mode
+    if(memcmp(&search->tableWeights, weights, sizeof *weights) || search->tableRotation != state->rotationMode)
+    {
+        vTransTableClear(search->table);
+        search->tableWeights = *weights;
+        search->tableRotation = state->rotationMode;
+    }
+
+    // Expand the beam level by level, starting with the current board
+    search->beam[0] = (ai_node_t){ .board = state->landed };
+    search->beamSize = 1;
+    for(int level=0; level<depth; level++)
+    {
+        search->piece = pieces[level];
+        search->root = level == 0;
+        search->last = level > 0 && level == depth-1;
+        if(search->pool && search->beamSize > 1)
+            vThreadPoolParallelFor(search->pool, search->beamSize, expandNode, search);
+        else
+            for(int i=0; i<search->beamSize; i++)
+                expandNode(i, 0, search);
+
+        // Rank all children, the level is dropped if it was not complete
+        int count = 0;
+        bool complete = true;
+        for(int i=0; i<search->beamSize; i++)
+        {
+            if(search->childCount[i] < 0)
+                complete = false;
+            for(int j=0; j<search->childCount[i]; j++)
+                search->ranking[count++] = &search->children[i * MAX_PLACEMENTS + j];
+        }
+        if(!complete || !count)
+        {
+            // Without any placement of the current Tetromino, the game is over
+            if(level == 0)
+                return false;
+            break;
+        }
+
+        // On the last level, pick the board with the best rating
+        if(search->last)
+        {
+            int bestIndex = -1;
+            for(int i=0; i<search->beamSize; i++)
+                if(search->childCount[i] && (bestIndex < 0 || search->leafRatings[i] > search->leafRatings[bestIndex]))
+                    bestIndex = i;
+            *best = search->beam[bestIndex].first;
+            return true;
+        }
+        qsort(search->ranking, count, sizeof *search->ranking, compareNodes);
+
+        // Keep the best distinct boards as the next beam
+        search->beamSize = 0;
+        for(int i=0; i<count && search->beamSize < search->width; i++)
+        {
+            int j = 0;
+            while(j < search->beamSize && search->beam[j].board.hash != search->ranking[i]->board.hash)
+                j++;
+            if(j == search->beamSize)
+                search->beam[search->beamSize++] = *search->ranking[i];
+        }
+    }
+
+    *best = search->beam[0].first;
+    return true;
+}
+
+game_input_t xAIGetInput(ai_player_t *ai, const game_state_t *state)
+{
+    const tetromino_t *current = &state->current;
+
+    // A new Tetromino was initialized in the last step
+    if(state->events & ENGINE_EVENT_LOCK)
+        ai->planned = false;
+    if(!ai->planned)
+    {
+        ai->planned = true;
+        ai->moves = 0;
+        bool found = ai->search ?
+            bAISearch(ai->search, state, &ai->weights, &ai->target) :
+            bAIFindPlacement(current, &state->landed, state->rotationMode, &ai->weights, &ai->target);
+        if(!found)
+            ai->target = (placement_t){ current->position, current->rotation, current->shape };
+    }
+
+    // Drop the Tetromino where it is, if it got stuck
+    if(++ai->moves > MAX_MOVES)
+        return ENGINE_INPUT_DROP;
+
+    if(current->shape != ai->target.shape)
+        return ENGINE_INPUT_ROTATE;
+    if(current->position.x > ai->target.position.x)
+        return ENGINE_INPUT_LEFT;
+    if(current->position.x < ai->target.position.x)
+        return ENGINE_INPUT_RIGHT;
+    return ENGINE_INPUT_DROP;
+}
+
+static void expandNode(int index, int worker, void *args)
+{
+    (void)worker;
+    ai_search_t *search = args;
+    const ai_node_t *parent = &search->beam[index];
+    ai_node_t *children = &search->children[index * MAX_PLACEMENTS];
+
+    // The current Tetromino is always placed, regardless of the budget
+    if(!search->root && search->deadline && now() >= search->deadline)
+    {
+        search->childCount[index] = -1;
+        return;
+    }
+
+    if(search->last)
+    {
+        float rating;
+        bool found = rateLeaf(search, &parent->board, &rating);
+        search->leafRatings[index] = rating + search->weights->rows * parent->rows;
+        search->childCount[index] = found;
+        return;
+    }
+
+    // If the Tetromino cannot spawn, there are no placements & the game is over on this board
+    placement_t placements[MAX_PLACEMENTS];
+    int count = iLogicGetPlacements(&search->piece, &parent->board, search->rotationMode, placements, MAX_PLACEMENTS);
+    count = filterReachable(&search->piece, &parent->board, search->rotationMode, placements, count);
+
+    const board_t *boards[MAX_PLACEMENTS];
+    for(int i=0; i<count; i++)
+    {
+        ai_node_t *child = &children[i];
+        child->board = parent->board;
+        tetromino_t placed = search->piece;
+        placed.position = placements[i].position;
+        placed.shape = placements[i].shape;
+        vLogicAddToLanded(&placed, &child->board);
+        score_t score = { 0 };
+        usLogicRowFull(&child->board, &score);
+
+        child->rows = parent->rows + score.rows;
+        child->first = search->root ? placements[i] : parent->first;
+        boards[i] = &child->board;
+    }
+
+    // Rate all children in one batch
+    board_features_t features[MAX_PLACEMENTS];
+    vEvaluateBoards(boards, count, features);
+    for(int i=0; i<count; i++)
+        children[i].rating = fAIEvaluate(&features[i], children[i].rows, search->weights);
+    search->childCount[index] = count;
+}
+
+static uint64_t tableKey(const board_t *landed, const tetromino_t *tetromino)
+{
+    bool spawn = tetromino->shape == pxLogicGetShape(tetromino->type, tetromino->rotation, true);
+    uint64_t piece =    (uint64_t)tetromino->type << 32 | 
+                        (uint64_t)tetromino->rotation << 24 |
+                        (uint64_t)(uint8_t)tetromino->position.x << 16 |
+                        (uint64_t)(uint8_t)tetromino->position.y << 8 |
+                        spawn;
+    return landed->hash ^ ullLogicHashKey(piece);
+}
+
+static bool rateLeaf(ai_search_t *search, const board_t *landed, float *rating)
+{
+    // The rating is stored in the lower 32 bits, bit 32 is set if a placement was found
+    uint64_t key = tableKey(landed, &search->piece);
+    uint64_t data;
+    if(!bTransTableLookup(search->table, key, &data))
+    {
+        placement_t placements[MAX_PLACEMENTS];
+        float ratings[MAX_PLACEMENTS];
+        int count = iLogicGetPlacements(&search->piece, landed, search->rotationMode, placements, MAX_PLACEMENTS);
+        count = filterReachable(&search->piece, landed, search->rotationMode, placements, count);
+        ratePlacements(&search->piece, landed, placements, count, search->weights, ratings);
+
+        float best = 0;
+        for(int i=0; i<count; i++)
+            if(i == 0 || ratings[i] > best)
+                best = ratings[i];
+        uint32_t bits;
+        memcpy(&bits, &best, sizeof bits);
+        data = (uint64_t)(count > 0) << 32 | bits;
+        vTransTableStore(search->table, key, data);
+    }
+
+    uint32_t bits = (uint32_t)data;
+    memcpy(rating, &bits, sizeof *rating);
+    return data >> 32;
+}
+
+static bool followPath( const tetromino_t *tetromino,
+                        const placement_t *placement,
+                        const board_t *landed,
+                        rotation_t rotationMode,
+                        bool gravity)
+{
+    tetromino_t piece = *tetromino;
+    piece.newPosition = piece.position;
+
+    // Same order of inputs as in xAIGetInput(), which drops the Tetromino after #MAX_MOVES inputs
+    for(int moves=0; moves<MAX_MOVES; moves++)
+    {
+        if(piece.shape != placement->shape)
+            vLogicRotate(&piece, landed, rotationMode);
+        else if(piece.position.x > placement->position.x)
+            vLogicUpdateXCoord(&piece, landed, LEFT_PRESSED);
+        else if(piece.position.x < placement->position.x)
+            vLogicUpdateXCoord(&piece, landed, RIGHT_PRESSED);
+        else
+            break;
+
+        if(gravity)
+            bLogicUpdateYCoord(&piece, landed);
+    }
+
+    return  piece.shape == placement->shape &&
+            piece.position.x == placement->position.x &&
+            piece.position.y + iLogicDropDistance(piece.shape, piece.position, landed) == placement->position.y;
+}
+
+static bool isReachable(const tetromino_t *tetromino, const placement_t *placement, const board_t *landed, rotation_t rotationMode)
+{
+    return  followPath(tetromino, placement, landed, rotationMode, false) &&
+            followPath(tetromino, placement, landed, rotationMode, true);
+}
+
+static void ratePlacements( const tetromino_t *tetromino,
+                            const board_t *landed,
+                            const placement_t placements[],
+                            int count,
+                            const ai_weights_t *weights,
+                            float ratings[])
+{
+    board_t boards[EVALUATE_BATCH];
+    const board_t *batch[EVALUATE_BATCH];
+    int rows[EVALUATE_BATCH];
+    board_features_t features[EVALUATE_BATCH];
+
+    for(int first=0; first<count; first+=EVALUATE_BATCH)
+    {
+        int size = count-first < EVALUATE_BATCH ? count-first : EVALUATE_BATCH;
+        for(int i=0; i<size; i++)
+        {
+            // Try the placement on a copy of the board
+            boards[i] = *landed;
+            tetromino_t placed = *tetromino;
+            placed.position = placements[first+i].position;
+            placed.shape = placements[first+i].shape;
+            vLogicAddToLanded(&placed, &boards[i]);
+            score_t score = { 0 };
+            usLogicRowFull(&boards[i], &score);
+            rows[i] = score.rows;
+            batch[i] = &boards[i];
+        }
+        vEvaluateBoards(batch, size, features);
+        for(int i=0; i<size; i++)
+            ratings[first+i] = fAIEvaluate(&features[i], rows[i], weights);
+    }
+}
+
+static int filterReachable(const tetromino_t *tetromino, const board_t *landed, rotation_t rotationMode, placement_t placements[], int count)
+{
+    int reachable = 0;
+    for(int i=0; i<count; i++)
+        if(isReachable(tetromino, &placements[i], landed, rotationMode))
+            placements[reachable++] = placements[i];
+    return reachable;
+}
+
+static int compareNodes(const void *a, const void *b)
+{
+    float ratingA = (*(ai_node_t * const *)a)->rating;
+    float ratingB = (*(ai_node_t * const *)b)->rating;
+    return (ratingA < ratingB) - (ratingA > ratingB);
+}
+
+static uint64_t now(void)
+{
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (uint64_t)time.tv_sec * 1000000 + time.tv_nsec / 1000;
+}
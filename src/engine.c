@@ -0,0 +1,193 @@
+#include "engine.h"
+
+// **********************************************************************************
+// Forward Declarations *************************************************************
+// **********************************************************************************
+/**
+ * @ingroup engine
+ * @brief Get a delay depending on the current level.
+ * 
+ * Above level 1, the delay decreases by 40ms per level, but never below #MIN_DELAY.
+ * @param[in] level (uint16_t): Current level. 
+ * @param[in] delay (int): Initial value of the delay. 
+ * @return (uint32_t): The delay in ms.
+ */
+static uint32_t levelDelay(uint16_t level, int delay);
+
+/**
+ * @ingroup engine
+ * @brief Add the current Tetromino to the landed ones, clear full rows & initialize the next Tetromino.
+ * @param[inout] state ( @ref game_state_t *): Game to update.
+ */
+static void lockTetromino(game_state_t *state);
+
+// **********************************************************************************
+// Function Definitions *************************************************************
+// **********************************************************************************
+void vEngineInit(   game_state_t *state, 
+                    player_mode_t playerMode, 
+                    rotation_t rotationMode, 
+                    uint8_t level, 
+                    const tetromino_type_t types[2],
+                    uint32_t seed)
+{
+    *state = (game_state_t){ 0 };
+    state->playerMode = playerMode;
+    state->rotationMode = rotationMode;
+    state->score.level = level;
+    state->seed = seed;
+    vLogicSeedRandom(&state->rng, seed);
+    vLogicInitBag(&state->bag, ulLogicRandom(&state->rng));
+
+    // In multiplayer mode, the types are set by the opponent
+    if(playerMode == MULTI_PLAYER && types)
+    {
+        state->current.type = types[0];
+        state->next.type = types[1];
+    }
+    // Initialize both Tetrominos
+    vLogicInitTetromino(&state->current, &state->bag, playerMode, &state->rng);
+    vLogicInitTetromino(&state->next, &state->bag, playerMode, &state->rng);
+
+    // Init the delays with the current level
+    state->gravityPeriod = levelDelay(level, POS_UPDATE_DELAY);
+    state->groundPeriod = levelDelay(level, DELAY_AT_BOTTOM);
+    state->startDelay = true;
+}
+
+bool bEngineStep(game_state_t *state, game_input_t input, uint32_t dt)
+{
+    state->events = 0;
+    state->clearedRows = 0;
+
+    // Checking if the current tetromino will cause the game to be over,
+    // before doing any movement.
+    state->gameOver = bLogicCheckGameOver(&state->current, &state->landed);
+    if(state->gameOver)
+    {
+        state->events |= ENGINE_EVENT_GAME_OVER;
+        return false;
+    }
+
+    // Advance the delays ***********************************************************
+    state->gravityElapsed += dt;
+    if(state->gravityElapsed >= state->gravityPeriod)
+    {
+        state->gravityElapsed %= state->gravityPeriod;
+        state->gravityPending = true;
+    }
+    bool lockPending = false;
+    if(state->groundDelayActive)
+    {
+        state->groundElapsed += dt;
+        if(state->groundElapsed >= state->groundPeriod)
+        {
+            state->groundDelayActive = false;
+            lockPending = true;
+        }
+    }
+
+    // If the delay at the ground is active, it is restarted, if:
+    // - a button is pressed
+    // - the tetromino can be moved further downwards
+    if(state->groundDelayActive)
+    {
+        bool buttonPressed = input & (ENGINE_INPUT_LEFT | ENGINE_INPUT_RIGHT | ENGINE_INPUT_ROTATE);
+        coord_t down = {state->current.position.x, state->current.position.y + 1};
+        if(buttonPressed || bLogicCheckMove(state->current.shape, down, &state->landed))
+            state->groundElapsed = 0;
+    }
+
+    // Update Tetromino *************************************************************
+    // Move the Tetromino on the x-axis, left has priority if both are pressed
+    if(input & ENGINE_INPUT_LEFT)
+        vLogicUpdateXCoord(&state->current, &state->landed, LEFT_PRESSED);
+    else if(input & ENGINE_INPUT_RIGHT)
+        vLogicUpdateXCoord(&state->current, &state->landed, RIGHT_PRESSED);
+
+    // Rotate the Tetromino
+    if(input & ENGINE_INPUT_ROTATE)
+        vLogicRotate(&state->current, &state->landed, state->rotationMode);
+
+    // Drop the Tetromino straight to its landing row & lock it without waiting for the delay at the ground
+    if(input & ENGINE_INPUT_DROP)
+    {
+        state->current.position.y += iLogicDropDistance(state->current.shape, state->current.position, &state->landed);
+        state->current.newPosition = state->current.position;
+        state->gravityPending = false;
+        state->groundDelayActive = false;
+        state->events |= ENGINE_EVENT_GROUND;
+        lockTetromino(state);
+        return true;
+    }
+
+    // Move the Tetromino down, 
+    // if the down-key is held, the pending fall is kept for the next step
+    if(input & ENGINE_INPUT_DOWN)
+        state->okNext = !bLogicUpdateYCoord(&state->current, &state->landed);
+    else if(state->gravityPending)
+    {
+        state->gravityPending = false;
+        state->okNext = !bLogicUpdateYCoord(&state->current, &state->landed);
+        if(state->okNext)
+            state->events |= ENGINE_EVENT_FALL;
+    }
+
+    // If a Tetromino hits the ground, 
+    // a delay is started, so that the player has some time
+    // to move the tetromino around after hitting the ground.
+    // The timespan of this delay also decreases when the level gets higher
+    if(state->okNext && state->startDelay)
+    {
+        state->groundPeriod = levelDelay(state->score.level, DELAY_AT_BOTTOM);
+        state->groundElapsed = 0;
+        state->groundDelayActive = true;
+        state->startDelay = false;
+        state->events |= ENGINE_EVENT_GROUND;
+    }
+
+    // If the delay at the ground has run out, the next Tetromino can be initialized
+    if(lockPending)
+        lockTetromino(state);
+
+    return true;
+}
+
+static void lockTetromino(game_state_t *state)
+{
+    // Add the Tetromino to the board of landed Tetrominos
+    vLogicAddToLanded(&state->current, &state->landed);
+    // Check if row(s) are full
+    state->clearedRows = usLogicRowFull(&state->landed, &state->score);
+    if(state->clearedRows)
+        state->events |= ENGINE_EVENT_ROWS;
+    // The initialize the new (current) Tetromino
+    state->current = state->next;
+    // If in multiplayer mode, take the next tetromino type from the opponent
+    if(state->playerMode == MULTI_PLAYER)
+    {
+        if(state->pendingType != NO_TYPE)
+        {
+            state->next.type = state->pendingType;
+            state->pendingType = NO_TYPE;
+        }
+        else
+            state->events |= ENGINE_EVENT_NO_TYPE;
+    }
+
+    // Initialize the next Tetromino & reset flags
+    vLogicInitTetromino(&state->next, &state->bag, state->playerMode, &state->rng);
+    state->okNext = false;
+    state->startDelay = true;
+    // Restart the delay for updating the position
+    state->gravityPeriod = levelDelay(state->score.level, POS_UPDATE_DELAY);
+    state->gravityElapsed = 0;
+    state->events |= ENGINE_EVENT_LOCK;
+}
+
+static uint32_t levelDelay(uint16_t level, int delay)
+{
+    if(level > 1)
+        delay -= level * 40;
+    return delay < MIN_DELAY ? MIN_DELAY : delay;
+}
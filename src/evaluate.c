@@ -0,0 +1,274 @@
+#include "evaluate.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define EVALUATE_X86 ///< The SIMD kernels can be compiled
+#endif
+
+/**
+ * @name Evaluation Masks
+ * @{
+ */
+#define WALLED_ROW(row) (((row) << 1) | 1 | (1 << (COLS+1)))   ///< Row with the walls as occupied squares on both sides
+#define WALL_PAIRS ((1 << (COLS+1)) - 1)    ///< Pairs of neighbouring squares in a walled row
+#define COLUMN_PAIRS ((1 << (COLS-1)) - 1)  ///< Pairs of neighbouring columns
+///@}
+
+/**
+ * @ingroup evaluate
+ * @brief Index of a feature in the sums of a kernel.
+ */
+enum feature
+{
+    HEIGHT,
+    HOLES,
+    BUMPINESS,
+    ROW_TRANSITIONS,
+    COLUMN_TRANSITIONS,
+    FEATURE_COUNT
+};
+
+/**
+ * @ingroup evaluate
+ * @brief Kernel computing the features of one batch.
+ *
+ * @p lanes holds row n of every board of the batch in lanes[n], one board per 16-bit lane.
+ */
+typedef void (*evaluate_kernel_t)(  const uint16_t lanes[ROWS][EVALUATE_BATCH],
+                                    uint16_t sums[FEATURE_COUNT][EVALUATE_BATCH]);
+
+// **********************************************************************************
+// Forward Declarations *************************************************************
+// **********************************************************************************
+/**
+ * @ingroup evaluate
+ * @brief Kernel for any CPU, one board after the other.
+ * @param[in] lanes (const uint16_t [][]): The transposed rows of the batch.
+ * @param[out] sums (uint16_t [][]): The features of each board of the batch.
+ */
+static void evaluateScalar( const uint16_t lanes[ROWS][EVALUATE_BATCH],
+                            uint16_t sums[FEATURE_COUNT][EVALUATE_BATCH]);
+
+#ifdef EVALUATE_X86
+/**
+ * @ingroup evaluate
+ * @brief Kernel for CPUs with SSE2, 8 boards at once.
+ * @param[in] lanes (const uint16_t [][]): The transposed rows of the batch.
+ * @param[out] sums (uint16_t [][]): The features of each board of the batch.
+ */
+__attribute__((target("sse2")))
+static void evaluateSSE2(   const uint16_t lanes[ROWS][EVALUATE_BATCH],
+                            uint16_t sums[FEATURE_COUNT][EVALUATE_BATCH]);
+
+/**
+ * @ingroup evaluate
+ * @brief Kernel for CPUs with AVX2, all 16 boards at once.
+ * @param[in] lanes (const uint16_t [][]): The transposed rows of the batch.
+ * @param[out] sums (uint16_t [][]): The features of each board of the batch.
+ */
+__attribute__((target("avx2")))
+static void evaluateAVX2(   const uint16_t lanes[ROWS][EVALUATE_BATCH],
+                            uint16_t sums[FEATURE_COUNT][EVALUATE_BATCH]);
+#endif // EVALUATE_X86
+
+/**
+ * @ingroup evaluate
+ * @brief Pick the fastest kernel, that the CPU supports.
+ * @return ( @ref evaluate_kernel_t): The kernel.
+ */
+static evaluate_kernel_t getKernel(void);
+
+// **********************************************************************************
+// Function Definitions *************************************************************
+// **********************************************************************************
+void vEvaluateBoards(const board_t *const boards[], int count, board_features_t features[])
+{
+    evaluate_kernel_t kernel = getKernel();
+    _Alignas(32) uint16_t lanes[ROWS][EVALUATE_BATCH];
+    _Alignas(32) uint16_t sums[FEATURE_COUNT][EVALUATE_BATCH];
+
+    for(int first=0; first<count; first+=EVALUATE_BATCH)
+    {
+        int batch = count - first < EVALUATE_BATCH ? count - first : EVALUATE_BATCH;
+
+        // Transpose the rows, unused lanes hold empty boards
+        if(batch < EVALUATE_BATCH)
+            memset(lanes, 0, sizeof(lanes));
+        for(int i=0; i<batch; i++)
+            for(int row=0; row<ROWS; row++)
+                lanes[row][i] = boards[first+i]->rows[row];
+
+        kernel(lanes, sums);
+
+        for(int i=0; i<batch; i++)
+            features[first+i] = (board_features_t){
+                .height = sums[HEIGHT][i],
+                .holes = sums[HOLES][i],
+                .bumpiness = sums[BUMPINESS][i],
+                .rowTransitions = sums[ROW_TRANSITIONS][i],
+                .columnTransitions = sums[COLUMN_TRANSITIONS][i]
+            };
+    }
+}
+
+const char *pcEvaluateGetKernel(void)
+{
+    evaluate_kernel_t kernel = getKernel();
+#ifdef EVALUATE_X86
+    if(kernel == evaluateAVX2)
+        return "AVX2";
+    if(kernel == evaluateSSE2)
+        return "SSE2";
+#endif // EVALUATE_X86
+    return kernel == evaluateScalar ? "scalar" : "unknown";
+}
+
+static evaluate_kernel_t getKernel(void)
+{
+#ifdef EVALUATE_X86
+    if(__builtin_cpu_supports("avx2"))
+        return evaluateAVX2;
+    if(__builtin_cpu_supports("sse2"))
+        return evaluateSSE2;
+#endif // EVALUATE_X86
+    return evaluateScalar;
+}
+
+static void evaluateScalar( const uint16_t lanes[ROWS][EVALUATE_BATCH],
+                            uint16_t sums[FEATURE_COUNT][EVALUATE_BATCH])
+{
+    for(int i=0; i<EVALUATE_BATCH; i++)
+    {
+        unsigned int covered = 0, above = 0;
+        int height = 0, holes = 0, bumpiness = 0, rowTransitions = 0, columnTransitions = 0;
+        for(int row=ROWS-1; row>=0; row--)
+        {
+            unsigned int mask = lanes[row][i];
+            unsigned int walled = WALLED_ROW(mask);
+            covered |= mask;
+            height += __builtin_popcount(covered);
+            holes += __builtin_popcount(covered & ~mask);
+            bumpiness += __builtin_popcount((covered ^ (covered >> 1)) & COLUMN_PAIRS);
+            rowTransitions += __builtin_popcount((walled ^ (walled >> 1)) & WALL_PAIRS);
+            columnTransitions += __builtin_popcount(mask ^ above);
+            above = mask;
+        }
+        // The ground counts as occupied
+        columnTransitions += __builtin_popcount(~above & FULL_ROW);
+
+        sums[HEIGHT][i] = height;
+        sums[HOLES][i] = holes;
+        sums[BUMPINESS][i] = bumpiness;
+        sums[ROW_TRANSITIONS][i] = rowTransitions;
+        sums[COLUMN_TRANSITIONS][i] = columnTransitions;
+    }
+}
+
+#ifdef EVALUATE_X86
+/**
+ * @ingroup evaluate
+ * @brief Count the set bits of each 16-bit lane with SSE2.
+ * @param[in] x (__m128i): 8 lanes.
+ * @return (__m128i): The number of set bits of each lane.
+ */
+__attribute__((target("sse2")))
+static inline __m128i popcountSSE2(__m128i x)
+{
+    x = _mm_sub_epi16(x, _mm_and_si128(_mm_srli_epi16(x, 1), _mm_set1_epi16(0x5555)));
+    x = _mm_add_epi16(_mm_and_si128(x, _mm_set1_epi16(0x3333)), _mm_and_si128(_mm_srli_epi16(x, 2), _mm_set1_epi16(0x3333)));
+    x = _mm_and_si128(_mm_add_epi16(x, _mm_srli_epi16(x, 4)), _mm_set1_epi16(0x0F0F));
+    return _mm_and_si128(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), _mm_set1_epi16(0x001F));
+}
+
+__attribute__((target("sse2")))
+static void evaluateSSE2(   const uint16_t lanes[ROWS][EVALUATE_BATCH],
+                            uint16_t sums[FEATURE_COUNT][EVALUATE_BATCH])
+{
+    const __m128i full = _mm_set1_epi16(FULL_ROW);
+    const __m128i wallPairs = _mm_set1_epi16(WALL_PAIRS);
+    const __m128i columnPairs = _mm_set1_epi16(COLUMN_PAIRS);
+    const __m128i walls = _mm_set1_epi16(1 | (1 << (COLS+1)));
+
+    for(int half=0; half<EVALUATE_BATCH; half+=8)
+    {
+        __m128i covered = _mm_setzero_si128(), above = _mm_setzero_si128();
+        __m128i height = covered, holes = covered, bumpiness = covered;
+        __m128i rowTransitions = covered, columnTransitions = covered;
+        for(int row=ROWS-1; row>=0; row--)
+        {
+            __m128i mask = _mm_load_si128((const __m128i*)&lanes[row][half]);
+            __m128i walled = _mm_or_si128(_mm_slli_epi16(mask, 1), walls);
+            covered = _mm_or_si128(covered, mask);
+            height = _mm_add_epi16(height, popcountSSE2(covered));
+            holes = _mm_add_epi16(holes, popcountSSE2(_mm_andnot_si128(mask, covered)));
+            bumpiness = _mm_add_epi16(bumpiness, popcountSSE2(
+                _mm_and_si128(_mm_xor_si128(covered, _mm_srli_epi16(covered, 1)), columnPairs)));
+            rowTransitions = _mm_add_epi16(rowTransitions, popcountSSE2(
+                _mm_and_si128(_mm_xor_si128(walled, _mm_srli_epi16(walled, 1)), wallPairs)));
+            columnTransitions = _mm_add_epi16(columnTransitions, popcountSSE2(_mm_xor_si128(mask, above)));
+            above = mask;
+        }
+        // The ground counts as occupied
+        columnTransitions = _mm_add_epi16(columnTransitions, popcountSSE2(_mm_andnot_si128(above, full)));
+
+        _mm_store_si128((__m128i*)&sums[HEIGHT][half], height);
+        _mm_store_si128((__m128i*)&sums[HOLES][half], holes);
+        _mm_store_si128((__m128i*)&sums[BUMPINESS][half], bumpiness);
+        _mm_store_si128((__m128i*)&sums[ROW_TRANSITIONS][half], rowTransitions);
+        _mm_store_si128((__m128i*)&sums[COLUMN_TRANSITIONS][half], columnTransitions);
+    }
+}
+
+/**
+ * @ingroup evaluate
+ * @brief Count the set bits of each 16-bit lane with AVX2, looking up each nibble.
+ * @param[in] x (__m256i): 16 lanes.
+ * @return (__m256i): The number of set bits of each lane.
+ */
+__attribute__((target("avx2")))
+static inline __m256i popcountAVX2(__m256i x)
+{
+    const __m256i table = _mm256_setr_epi8(0,1,1,2,1,2,2,3,1,2,2,3,2,3,3,4, 0,1,1,2,1,2,2,3,1,2,2,3,2,3,3,4);
+    const __m256i nibble = _mm256_set1_epi8(0x0F);
+    __m256i low = _mm256_shuffle_epi8(table, _mm256_and_si256(x, nibble));
+    __m256i high = _mm256_shuffle_epi8(table, _mm256_and_si256(_mm256_srli_epi16(x, 4), nibble));
+    __m256i bytes = _mm256_add_epi8(low, high);
+    return _mm256_add_epi16(_mm256_and_si256(bytes, _mm256_set1_epi16(0x00FF)), _mm256_srli_epi16(bytes, 8));
+}
+
+__attribute__((target("avx2")))
+static void evaluateAVX2(   const uint16_t lanes[ROWS][EVALUATE_BATCH],
+                            uint16_t sums[FEATURE_COUNT][EVALUATE_BATCH])
+{
+    const __m256i full = _mm256_set1_epi16(FULL_ROW);
+    const __m256i wallPairs = _mm256_set1_epi16(WALL_PAIRS);
+    const __m256i columnPairs = _mm256_set1_epi16(COLUMN_PAIRS);
+    const __m256i walls = _mm256_set1_epi16(1 | (1 << (COLS+1)));
+
+    __m256i covered = _mm256_setzero_si256(), above = _mm256_setzero_si256();
+    __m256i height = covered, holes = covered, bumpiness = covered;
+    __m256i rowTransitions = covered, columnTransitions = covered;
+    for(int row=ROWS-1; row>=0; row--)
+    {
+        __m256i mask = _mm256_load_si256((const __m256i*)lanes[row]);
+        __m256i walled = _mm256_or_si256(_mm256_slli_epi16(mask, 1), walls);
+        covered = _mm256_or_si256(covered, mask);
+        height = _mm256_add_epi16(height, popcountAVX2(covered));
+        holes = _mm256_add_epi16(holes, popcountAVX2(_mm256_andnot_si256(mask, covered)));
+        bumpiness = _mm256_add_epi16(bumpiness, popcountAVX2(
+            _mm256_and_si256(_mm256_xor_si256(covered, _mm256_srli_epi16(covered, 1)), columnPairs)));
+        rowTransitions = _mm256_add_epi16(rowTransitions, popcountAVX2(
+            _mm256_and_si256(_mm256_xor_si256(walled, _mm256_srli_epi16(walled, 1)), wallPairs)));
+        columnTransitions = _mm256_add_epi16(columnTransitions, popcountAVX2(_mm256_xor_si256(mask, above)));
+        above = mask;
+    }
+    // The ground counts as occupied
+    columnTransitions = _mm256_add_epi16(columnTransitions, popcountAVX2(_mm256_andnot_si256(above, full)));
+
+    _mm256_store_si256((__m256i*)sums[HEIGHT], height);
+    _mm256_store_si256((__m256i*)sums[HOLES], holes);
+    _mm256_store_si256((__m256i*)sums[BUMPINESS], bumpiness);
+    _mm256_store_si256((__m256i*)sums[ROW_TRANSITIONS], rowTransitions);
+    _mm256_store_si256((__m256i*)sums[COLUMN_TRANSITIONS], columnTransitions);
+}
+#endif // EVALUATE_X86
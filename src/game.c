@@ -9,17 +9,13 @@
 #include "game.h"
 #include "input.h"
 #include "stateMachine.h"
-#include "logic.h"
+#include "engine.h"
+#include "ai.h"
 #include "gui.h"
 #include "opponent.h"
 
-/**
- * @name Delays
- * @{
- */
-#define POS_UPDATE_DELAY 500    ///< Initial value for the delay for updating a Tetromino's position
-#define DELAY_AT_BOTTOM 300     ///< Initial value for the delay when a Tetromino hits the bottom
-///@}
+#define MAX_FRAME_TIME 100 ///< Upper bound for the time between two frames, e.g. after the game was paused
+#define SEED_TIMEOUT 100 ///< Time in ms to wait for the UDP task to send a new seed to the opponent after a reset
 
 // **********************************************************************************
 // Global Variables *****************************************************************
@@ -37,23 +33,10 @@ TaskHandle_t PauseTask                      = NULL; ///< @ref TaskHandle_t "Task
 TaskHandle_t ScoreTask                      = NULL; ///< @ref TaskHandle_t "Task" for the Score Task
 ///@}
 
-// **********************************************************************************
-/// \name Timer Handles
-///@{
-TimerHandle_t PosUpdateTimer                = NULL; ///< @ref TimerHandle_t "Timer" for updating a Tetromino's position
-TimerHandle_t DelayAtGroundTimer            = NULL; ///< @ref TimerHandle_t "Timer" for the delay, when a Tetromino hits the bottom
-///@}
-
 // **********************************************************************************
 /// \name Semaphore Handles
 ///@{
-SemaphoreHandle_t ScreenLock                = NULL; ///< @ref SemaphoreHandle_t "Semaphore" for locking the screen
 SemaphoreHandle_t DrawSignal                = NULL; ///< @ref SemaphoreHandle_t "Signal" for drawing
-SemaphoreHandle_t YSignal             = NULL; ///< @ref SemaphoreHandle_t "Signal" for updating a Tetromino's y-position
-SemaphoreHandle_t XSignal             = NULL; ///< @ref SemaphoreHandle_t "Signal" for updating a Tetromino's x-position
-SemaphoreHandle_t FallSignal         = NULL; ///< @ref SemaphoreHandle_t "Signal" if the down-key is held
-SemaphoreHandle_t RotationSignal            = NULL; ///< @ref SemaphoreHandle_t "Signal" for rotating a Tetromino
-SemaphoreHandle_t InitNextSignal   = NULL; ///< @ref SemaphoreHandle_t "Signal" for initializing the next Tetromino
 SemaphoreHandle_t ResetGameSignal           = NULL; ///< @ref SemaphoreHandle_t "Signal" for resetting the game
 SemaphoreHandle_t ResetUDPSignal            = NULL; ///< @ref SemaphoreHandle_t "Signal" for resetting the UDP socket
 SemaphoreHandle_t NoConnectionSignal        = NULL; ///< @ref SemaphoreHandle_t "Signal" if the binary is not connected
@@ -62,7 +45,6 @@ SemaphoreHandle_t NoConnectionSignal        = NULL; ///< @ref SemaphoreHandle_t
 // **********************************************************************************
 /// \name Queue Handles
 ///@{
-QueueHandle_t LeftRightQueue                = NULL; ///< @ref QueueHandle_t "Queue" for left & right input
 QueueHandle_t ConnectionQueue               = NULL; ///< @ref QueueHandle_t "Queue" for the connection status
 QueueHandle_t GameModeQueue                 = NULL; ///< @ref QueueHandle_t "Queue" for the game mode
 QueueHandle_t PlayerModeQueue               = NULL; ///< @ref QueueHandle_t "Queue" for the player mode
@@ -79,19 +61,10 @@ QueueHandle_t GameOverQueue                 = NULL; ///< @ref QueueHandle_t "Que
 // **********************************************************************************
 /**
  * @ingroup game
- * @brief Check for button input, give semaphores and write the pressed buttons in a queue.
- * @param[inout] buttonPressed (bool): whether a button was pressed.
- */
-static void buttonInput(bool *buttonPressed);
-
-/**
- * @ingroup game
- * @brief Change a timer's period depending on the current level & start the timer.
- * @param[inout] timer ( @ref TimerHandle_t): Timer to change period for. 
- * @param[in] level (uint8_t): Current level. 
- * @param[in] delay (int): The delay for changing the period. 
+ * @brief Check for button input & convert the pressed buttons into input for the @ref engine "Engine".
+ * @return ( @ref game_input_t): The pressed buttons.
  */
-static void changeTimerPeriod(TimerHandle_t timer, uint8_t level, int delay);
+static game_input_t buttonInput(void);
 
 /**
  * @ingroup game
@@ -153,37 +126,28 @@ static void mainMenuTask()
             if(HighScoresQueue)
                 xQueueReceive(HighScoresQueue, &highScores, 0);
 
-            // Entering critical section that cannot be interrupted *****************
-            taskENTER_CRITICAL();
-
-            if(xSemaphoreTake(ScreenLock, portMAX_DELAY) == pdTRUE)
+            // Draw *************************************************************
+            if(!drawLevelScreen)
             {
-                // Draw *************************************************************
-                if(!drawLevelScreen)
+                tumDrawClear(BACKGROUND_COLOR);
+                vGUIDrawMainMenu(mode, playerMode, rotationMode, isConnected);
+                // Selections for the different modes/menus
+                if(bGUIDrawPlayerModeSelection(&playerMode))
                 {
-                    tumDrawClear(BACKGROUND_COLOR);
-                    vGUIDrawMainMenu(mode, playerMode, rotationMode, isConnected);
-                    // Selections for the different modes/menus
-                    if(bGUIDrawPlayerModeSelection(&playerMode))
-                    {
-                        xQueueReset(PlayerModeQueue);
-                        xQueueSend(PlayerModeQueue, &playerMode, 0);
-                    }
-                    if(bGUIDrawRotationSelection(&rotationMode))
-                    {
-                        xQueueReset(RotationModeQueue);
-                        xQueueSend(RotationModeQueue, &rotationMode, 0);
-                    }
-                    if(bGUIDrawLevelMenuSelection())
-                        drawLevelScreen = true;
+                    xQueueReset(PlayerModeQueue);
+                    xQueueSend(PlayerModeQueue, &playerMode, 0);
                 }
-                else if(bGUIDrawLevelScreen(&currentLevel, highScores))
-                    drawLevelScreen = false;
+                if(bGUIDrawRotationSelection(&rotationMode))
+                {
+                    xQueueReset(RotationModeQueue);
+                    xQueueSend(RotationModeQueue, &rotationMode, 0);
+                }
+                if(bGUIDrawLevelMenuSelection())
+                    drawLevelScreen = true;
             }
-            // Return Screen Lock
-            xSemaphoreGive(ScreenLock);
-            // Exiting critical section *********************************************
-            taskEXIT_CRITICAL();
+            else if(bGUIDrawLevelScreen(&currentLevel, highScores))
+                drawLevelScreen = false;
+            tumDrawSubmitFrame();
 
             // Set level queue
             if(LevelQueue)
@@ -192,7 +156,7 @@ static void mainMenuTask()
                 xQueueSend(LevelQueue, &currentLevel, 0);
             }
             // Depending on the player mode, suspend or resume the UDP Task
-            if(playerMode == SINGLE_PLAYER && eTaskGetState(UDPControlTask) == eRunning) 
+            if(playerMode != MULTI_PLAYER && eTaskGetState(UDPControlTask) == eRunning) 
                 vTaskSuspend(UDPControlTask);
             if(playerMode == MULTI_PLAYER && eTaskGetState(UDPControlTask) == eSuspended)
                 vTaskResume(UDPControlTask);
@@ -202,36 +166,20 @@ static void mainMenuTask()
     }
 }
 
-/**
- * @ingroup game
- * @brief Callback function for the Timer that updates the position.
- * @param[in] PosUpdateTimer ( @ref TimerHandle_t): Timer to callback. 
- */
-static void posUpdateTimerCallback(TimerHandle_t PosUpdateTimer)
-{
-    xSemaphoreGive(YSignal);
-}
-
-/**
- * @ingroup game
- * @brief Callback function for the Timer that starts a delay if a Tetromino hits the bottom.
- * @param[in] DelayAtGroundTimer ( @ref TimerHandle_t): Timer to callback. 
- */
-static void delayAtBottomTimerCallback(TimerHandle_t DelayAtGroundTimer)
-{
-    xSemaphoreGive(InitNextSignal);
-}
-
 /**
  * @ingroup game
  * @brief Task that handles the Tetris gameplay.
  * 
+ * The gameplay itself is handled by the @ref engine "Engine", this task drives it once per frame.
  * -# If the #ResetGameSignal has been received, reset the game.
- * -# At the beginning/if the game is reset, the first Tetromino is initialized.
- * -# The Tetrominos position is updated, including x & y position & rotation.
- * -# If a Tetromino hits the ground, start a Timer, so that the player can move around the Tetromino further.
- * -# If the Tetromino is not moved anymore, initialize the next one & add the old one to the landed Tetrominos.
+ * -# At the beginning/if the game is reset, initialize the game with vEngineInit().
+ * -# Advance the game with bEngineStep(), using the button input & the time since the last frame.
+ *    In #AI_PLAYER mode, the input comes from the @ref ai "AI Module" instead,
+ *    which plans with a beam search on a @ref pool "Thread Pool".
+ * -# Play the sound effects for the events of that step.
  * -# Draw all aspects of the game, e.g. the falling Tetromino & the static elements.
+ *    The static elements & the landed Tetrominos are kept in a layer,
+ *    that is only drawn again when a Tetromino locks or the game is reset.
  * -# If the game is over, save the score & switch to the pause task.
  */
 static void gameTask()
@@ -239,74 +187,40 @@ static void gameTask()
     // ******************************************************************************
     // Init *************************************************************************
     // ******************************************************************************
-    // Timer ************************************************************************
-    PosUpdateTimer      = xTimerCreate( "PosUpdateTimer",
-                                        pdMS_TO_TICKS(POS_UPDATE_DELAY),
-                                        pdTRUE, 
-                                        NULL,
-                                        posUpdateTimerCallback);
-    DelayAtGroundTimer  = xTimerCreate( "DelayAtGroundTimer",
-                                        pdMS_TO_TICKS(DELAY_AT_BOTTOM),
-                                        pdFALSE, 
-                                        NULL,
-                                        delayAtBottomTimerCallback);
-    if(!PosUpdateTimer)     exit(EXIT_FAILURE);
-    if(!DelayAtGroundTimer) exit(EXIT_FAILURE);
-
     // Queues ***********************************************************************
-    LeftRightQueue  = xQueueCreate(1, sizeof(int));
     GameOverQueue   = xQueueCreate(1, sizeof(bool));
     ScoreQueue      = xQueueCreate(1, sizeof(score_t));
     HighScoresQueue = xQueueCreate(1, sizeof(score_t*));
     
-    if(!LeftRightQueue)     exit(EXIT_FAILURE);
     if(!ScoreQueue)         exit(EXIT_FAILURE);
     if(!HighScoresQueue)    exit(EXIT_FAILURE);
     if(!GameOverQueue)      exit(EXIT_FAILURE);
 
-    // Semaphores *******************************************************************
-    YSignal         = xSemaphoreCreateBinary();
-    XSignal         = xSemaphoreCreateBinary();
-    FallSignal      = xSemaphoreCreateBinary();
-    RotationSignal  = xSemaphoreCreateBinary();
-    InitNextSignal  = xSemaphoreCreateBinary();
-    
-    if(!YSignal)        exit(EXIT_FAILURE);
-    if(!XSignal)        exit(EXIT_FAILURE);
-    if(!FallSignal)     exit(EXIT_FAILURE);
-    if(!RotationSignal) exit(EXIT_FAILURE);
-    if(!InitNextSignal) exit(EXIT_FAILURE);
-
     // Flags ************************************************************************
-    bool okNext             = false;
-    bool initFirstTetromino = true;
-    bool startDelayTimer    = true;
-    bool gameOver           = false;
-    bool isConnected        = true;
-    bool buttonPressed      = false;
-    
-    // Array of landed tetrominos ***************************************************
-    color_t landed[ROWS][COLS] = { 0 };
+    bool initGame       = true;
+    bool gameOver       = false;
+    bool isConnected    = true;
 
     // Modes ************************************************************************
     player_mode_t playerMode = NO_PLAYER;
     rotation_t rotationMode = NO_ROTATION;
-
-    // Sequence of tetrominos for a fairer game *************************************
-    tetromino_type_t tetrominoSequence[7] = { 0 };
-    int sequenceIndex = 0;
-
-    // Current & upcoming tetrominos ************************************************
-    tetromino_t *tetromino  = malloc(sizeof *tetromino);
-    tetromino_t *next       = malloc(sizeof *next);
-    
-    // Score ************************************************************************
-    score_t *score = malloc(sizeof *score);
+    uint8_t level = 0;
+
+    // State of the game ************************************************************
+    game_state_t *state = malloc(sizeof *state);
+    if(!state) exit(EXIT_FAILURE);
+    ai_player_t ai = { 0 };
+    ai_search_t *search = NULL;
+    TickType_t lastFrame = xTaskGetTickCount();
     
     // Images ***********************************************************************
-    image_handle_t squares[NUMBER_OF_TETRIS_COLORS] = { NULL };
+    image_handle_t squares[NUMBER_OF_IMAGE_HANDLES] = { NULL };
     vGUISetImageHandle(squares);
 
+    // Layers ***********************************************************************
+    // Without a layer, everything is drawn to the screen in every frame
+    layer_handle_t background = tumDrawLayerCreate(SCREEN_WIDTH, SCREEN_HEIGHT);
+
     // Loop *************************************************************************
     while(1)
     {
@@ -315,43 +229,31 @@ static void gameTask()
             // Reset ****************************************************************
             if(xSemaphoreTake(ResetGameSignal, 0) == pdTRUE)
             {
-                xTimerStop(PosUpdateTimer, 0);
-                xQueueReset(LeftRightQueue);
-
-                initFirstTetromino = true;
-                sequenceIndex = 0;
+                initGame = true;
                 gameOver = false;
-                score->score = 0;
-                score->rows = 0; 
-                
-                for(int i=0; i<7; i++)
-                    tetrominoSequence[i] = NO_TYPE;
-
-                for(int row=0; row<ROWS; row++)
-                    for(int col=0; col<COLS; col++)
-                        landed[row][col] = 0;     
             }
 
             // Initialize the game **************************************************
-            if(initFirstTetromino)
+            if(initGame)
             {
-                initFirstTetromino = false;
+                initGame = false;
+                tumDrawLayerInvalidate(background);
                 // Read Queues
                 if(PlayerModeQueue)
                     xQueueReceive(PlayerModeQueue, &playerMode, 0);
                 if(RotationModeQueue)
                     xQueueReceive(RotationModeQueue, &rotationMode, 0);
                 if(LevelQueue)
-                    xQueuePeek(LevelQueue, &score->level, 0);
+                    xQueuePeek(LevelQueue, &level, 0);
 
                 // When initalizing the game in multiplayer mode,
                 // check if the binary sends the upcoming tetromino types.
                 // If so, the binary is connected, if not it is not.
                 // If the binary is connected, the connection status is sent via the
                 // ConnectionQueue to the PauseTask.
+                tetromino_type_t buf[2] = {NO_TYPE};
                 if(playerMode == MULTI_PLAYER)
                 {
-                    tetromino_type_t buf[2] = {NO_TYPE};
                     if(TetrominoQueue)
                         for(int i=0; i<2; i++)
                         {
@@ -360,10 +262,6 @@ static void gameTask()
                             else
                                 isConnected = false;
                         }
-                    
-                    // Set type for the current Tetromino & the upcoming one
-                    if(buf[0] != NO_TYPE) tetromino->type = buf[0];
-                    if(buf[1] != NO_TYPE) next->type = buf[1];
 
                     if(isConnected)
                     {
@@ -372,130 +270,89 @@ static void gameTask()
                         xQueueSend(ConnectionQueue, &isConnected, 0);
                     }
                 }
-                // Initialize both Tetrominos
-                vLogicInitTetromino(tetromino, tetrominoSequence, &sequenceIndex, playerMode);
-                vLogicInitTetromino(next, tetrominoSequence, &sequenceIndex, playerMode);
+                // The game is seeded with the seed that was last sent to the opponent.
+                // After a reset, the UDP task may not have sent the new one yet, so it is waited for.
+                // If there is none, e.g. in single player mode, a new one is generated.
+                int seed = time(NULL) ^ (xTaskGetTickCount() << 16);
+                if(SeedQueue)
+                    xQueueReceive(SeedQueue, &seed, playerMode == MULTI_PLAYER ? pdMS_TO_TICKS(SEED_TIMEOUT) : 0);
+
+                // Initialize the game with the types for the current Tetromino & the upcoming one
+                vEngineInit(state, playerMode, rotationMode, level, buf, seed);
+                // The beam search & its threads are only created, once the AI plays
+                if(playerMode == AI_PLAYER && !search)
+                {
+                    thread_pool_t *pool = pxThreadPoolCreate(0);
+                    if(!pool) exit(EXIT_FAILURE);
+                    search = pxAISearchCreate(AI_BEAM_WIDTH, AI_BEAM_DEPTH, AI_SEARCH_BUDGET, pool);
+                    if(!search) exit(EXIT_FAILURE);
+                }
+                ai_weights_t weights = AI_DEFAULT_WEIGHTS;
+                bAILoadWeights(AI_WEIGHTS_FILE, &weights);
+                vAIInit(&ai, &weights, search);
                 
-                // This Semaphore is taken, so that when resetting the game,
-                // the tetromino starts at the top and does not increase it's y-position
-                // before drawing it the first time
-                xSemaphoreTake(YSignal, 0);
-
-                // Init the period of the timer that updates the Tetromino position with the current level
-                changeTimerPeriod(PosUpdateTimer, score->level, POS_UPDATE_DELAY);
+                // The time before the first frame is not counted,
+                // so that the tetromino starts at the top
+                lastFrame = xTaskGetTickCount();
             }
 
+            // In multiplayer mode, keep the next type from the opponent ready,
+            // so that it can be used as soon as the current Tetromino lands
+            if(playerMode == MULTI_PLAYER && state->pendingType == NO_TYPE && TetrominoQueue)
+                if(xQueueReceive(TetrominoQueue, &state->pendingType, 0) == pdTRUE)
+                    xSemaphoreGive(NextTetrominoSignal);
+
             // Start of the main gameplay *******************************************
-            // Handle button input
+            // Measure the time since the last frame
+            TickType_t now = xTaskGetTickCount();
+            uint32_t dt = (now - lastFrame) * portTICK_PERIOD_MS;
+            lastFrame = now;
+            if(dt > MAX_FRAME_TIME) dt = MAX_FRAME_TIME;
+
+            // Handle button input & advance the game,
+            // in AI mode the buttons are still read, but the AI plays the game
             vGetButtonInput();
-            buttonInput(&buttonPressed);
-            
-            // Checking if the next tetromino will cause the game to be over,
-            // before doing any movement.
-            gameOver = bLogicCheckGameOver(tetromino, landed);
-            if(!gameOver)
+            game_input_t input = buttonInput();
+            if(playerMode == AI_PLAYER)
+                input = xAIGetInput(&ai, state);
+            gameOver = !bEngineStep(state, input, dt);
+            // The landed Tetrominos & the score only change, when a Tetromino locks
+            if(state->events & ENGINE_EVENT_LOCK)
+                tumDrawLayerInvalidate(background);
+
+            // Sound effects
+            if(ENABLE_SOUND_EFFECTS)
             {
-                // If the DelayAtGroundTimer is active, it is reset, if:
-                // - a button is pressed
-                // - the tetromino can be moved further downwards
-                if(xTimerIsTimerActive(DelayAtGroundTimer) != pdFALSE)
-                {
-                    coord_t down = {tetromino->position.x, tetromino->position.y + 1};
-                    if(buttonPressed || bLogicCheckMove(tetromino->shape, down, landed))
-                        xTimerStart(DelayAtGroundTimer, 0);
-                }
-                // Update Tetromino *************************************************
-                // Move the Tetromino on the x-axis
-                if(xSemaphoreTake(XSignal, 0) == pdTRUE)
-                {
-                    int pressedButton = 0;
-                    if(xQueueReceive(LeftRightQueue, &pressedButton, 0) == pdTRUE)
-                        vLogicUpdateXCoord(tetromino, landed, pressedButton);
-                }
-
-                // Rotate the Tetromino
-                if(xSemaphoreTake(RotationSignal, 0) == pdTRUE)
-                    vLogicRotate(tetromino, landed, rotationMode);
-
-                // Move the Tetromino down
-                if(xSemaphoreTake(FallSignal, 0) == pdTRUE)
-                    okNext = !bLogicUpdateYCoord(tetromino, landed);
-                else if(xSemaphoreTake(YSignal, 0) == pdTRUE)
-                {
-                    okNext = !bLogicUpdateYCoord(tetromino, landed);
-                    if(!okNext && ENABLE_SOUND_EFFECTS)
-                        tumSoundPlayUserSample(FALLING_SOUND); 
-                }
-                        
-                // If a Tetromino hits the ground, 
-                // a delay is started, so that the player has some time
-                // to move the tetromino around after hitting the ground.
-                // The timespan of this delay also decreases when the level gets higher
-                if(okNext && startDelayTimer)
-                {
-                    if(ENABLE_SOUND_EFFECTS) tumSoundPlayUserSample(THUMP_SOUND);
-                    // This function changes the timer's period and starts it as well
-                    changeTimerPeriod(DelayAtGroundTimer, score->level, DELAY_AT_BOTTOM);
-                    startDelayTimer = false;
-                }
-                // Initialize next Tetromino ****************************************
-                // If the timer for the delay at ground has run out, this signal is given
-                // If this signal is given, the next Tetromino can be initialized
-                if(xSemaphoreTake(InitNextSignal, 0) == pdTRUE)
-                {
-                    xTimerStop(PosUpdateTimer, 0);                        
-                    // Add the Tetromino to the array of landed Tetrominos
-                    vLogicAddToLanded(tetromino, landed);
-                    // Check if row(s) are full
-                    if(vLogicRowFull(landed, score) && ENABLE_SOUND_EFFECTS)
-                        tumSoundPlayUserSample(ROW_FULL_SOUND);
-                    // The initialize the new (current) Tetromino
-                    *tetromino = *next;
-                    // If in multiplayer mode, read the next tetromino type from the opponent
-                    if(playerMode == MULTI_PLAYER)
-                    {
-                        tetromino_type_t buf = NO_TYPE;
-                        if(xQueueReceive(TetrominoQueue, &buf, 0) == pdTRUE)
-                        {
-                            isConnected = true;
-                            if(buf != NO_TYPE) next->type = buf;
-                            xSemaphoreGive(NextTetrominoSignal);
-                        }
-                        else
-                            isConnected = false;
-                    }
-
-                    // Initialize the next Tetromino & reset flags
-                    vLogicInitTetromino(next, tetrominoSequence, &sequenceIndex, playerMode);
-                    okNext = false;
-                    startDelayTimer = true;
-                    // Restart the timer for updating the position
-                    changeTimerPeriod(PosUpdateTimer, score->level, POS_UPDATE_DELAY);
-                }
+                if(state->events & ENGINE_EVENT_FALL)   tumSoundPlayUserSample(FALLING_SOUND);
+                if(state->events & ENGINE_EVENT_GROUND) tumSoundPlayUserSample(THUMP_SOUND);
+                if(state->events & ENGINE_EVENT_ROWS)   tumSoundPlayUserSample(ROW_FULL_SOUND);
             }
+            // If in multiplayer mode no type from the opponent was ready, it is not connected anymore
+            if(state->events & ENGINE_EVENT_LOCK && playerMode == MULTI_PLAYER)
+                isConnected = !(state->events & ENGINE_EVENT_NO_TYPE);
 
-            // Entering a critical section, that cannot be interrupted **************
-            taskENTER_CRITICAL();
             // Draw *****************************************************************
-            if(xSemaphoreTake(ScreenLock, portMAX_DELAY) == pdTRUE)
+            // Draw static elements: score, level, rows & the landed Tetrominos
+            if(!tumDrawLayerIsValid(background))
             {
+                tumDrawLayerBegin(background);
                 tumDrawClear(BACKGROUND_COLOR);
-                // Draw static elements: score, level, rows
-                vGUIDrawStatic(squares, score);
-                vGUIDrawFPS();
-                // Once again check if the game is over after moving the Tetromino
-                if(!bLogicCheckGameOver(tetromino, landed))
-                {
-                    vGUIDrawTetromino(tetromino, squares);
-                    vGUIDrawNextTetromino(next, squares);
-                } 
-                else if(ENABLE_SOUND_EFFECTS)
-                    tumSoundPlayUserSample(GAME_OVER_SOUND);
-                vGUIDrawLanded(landed, squares);
+                vGUIDrawStatic(squares, &state->score);
+                vGUIDrawLanded(&state->landed, squares);
+                tumDrawLayerEnd();
             }
-            xSemaphoreGive(ScreenLock);
-            // Exiting critical section *********************************************
-            taskEXIT_CRITICAL();
+            tumDrawLayer(background, 0, 0);
+            vGUIDrawFPS();
+            // Once again check if the game is over after moving the Tetromino
+            if(!bLogicCheckGameOver(&state->current, &state->landed))
+            {
+                vGUIDrawGhost(&state->current, &state->landed);
+                vGUIDrawTetromino(&state->current, squares);
+                vGUIDrawNextTetromino(&state->next, squares);
+            } 
+            else if(ENABLE_SOUND_EFFECTS)
+                tumSoundPlayUserSample(GAME_OVER_SOUND);
+            tumDrawSubmitFrame();
 
             // Send game over status
             xQueueReset(GameOverQueue);
@@ -517,8 +374,7 @@ static void gameTask()
             {
                 gameOver = false;
                 xQueueReset(ScoreQueue);
-                xQueueSend(ScoreQueue, score, 0);
-                xTimerStop(PosUpdateTimer, 0);
+                xQueueSend(ScoreQueue, &state->score, 0);
 
                 // The pause task is resumed
                 if(StateQueue)
@@ -560,24 +416,17 @@ static void pauseTask()
             if(ConnectionQueue)
                 xQueuePeek(ConnectionQueue, &isConnected, 0);
 
-            // Entering a critical section that cannot be interrupted ***********
-            taskENTER_CRITICAL();
-            if(xSemaphoreTake(ScreenLock, portMAX_DELAY) == pdTRUE)
+            // If the game is still going, draw the pause menu
+            if(!gameOver) vGUIDrawPauseMenu(isConnected);
+            // Otherwise draw the game over menu
+            else
             {
-                // If the game is still going, draw the pause menu
-                if(!gameOver) vGUIDrawPauseMenu(isConnected);
-                // Otherwise draw the game over menu
-                else
-                {
-                    vGUIDrawGameOverMenu(&score, lastUserName);
-                    xQueueReset(ScoreQueue);
-                    xQueueSend(ScoreQueue, &score, 0);
-                    vTaskResume(ScoreTask);
-                }
+                vGUIDrawGameOverMenu(&score, lastUserName);
+                xQueueReset(ScoreQueue);
+                xQueueSend(ScoreQueue, &score, 0);
+                vTaskResume(ScoreTask);
             }
-            xSemaphoreGive(ScreenLock);
-            // Exiting critical section *********************************************
-            taskEXIT_CRITICAL();
+            tumDrawSubmitFrame();
 
             iCheckStateInput(NO_PLAYER, isConnected, NO_ROTATION, gameOver);
         }
@@ -627,68 +476,39 @@ static void scoreTask()
     }
 }
 
-static void buttonInput(bool *buttonPressed)
+static game_input_t buttonInput(void)
 {
-    int buf = 0;
-    *buttonPressed = false;
-    static debounce_button_t debounceUp = { 0 }, debounceRight = { 0 }, debounceLeft = { 0 };
+    game_input_t input = 0;
+    static debounce_button_t debounceUp = { 0 }, debounceRight = { 0 }, debounceLeft = { 0 }, debounceSpace = { 0 };
 
     if(xSemaphoreTake(buttons.lock, portMAX_DELAY) == pdTRUE)
     {
         // Left arrow ***************************************************************
         if(bGameDebounceButton(buttons.buttons[SDL_SCANCODE_LEFT], &debounceLeft.lastState))
-        {
-            buf = LEFT_PRESSED;
-            xQueueReset(LeftRightQueue);
-            if(xQueueSend(LeftRightQueue, &buf, 0) == pdTRUE)
-            {
-                xSemaphoreGive(XSignal);
-                *buttonPressed = true;
-            }
-        }
+            input |= ENGINE_INPUT_LEFT;
         // Right arrow **************************************************************
         if(bGameDebounceButton(buttons.buttons[SDL_SCANCODE_RIGHT], &debounceRight.lastState))
-        { 
-            buf = RIGHT_PRESSED;
-            if(xQueueSend(LeftRightQueue, &buf, 0) == pdTRUE)
-            {
-                xSemaphoreGive(XSignal);
-                *buttonPressed  = true;
-            }
-        }
+            input |= ENGINE_INPUT_RIGHT;
         // Up arrow *****************************************************************
         if(bGameDebounceButton(buttons.buttons[SDL_SCANCODE_UP], &debounceUp.lastState))
-        {
-            xSemaphoreGive(RotationSignal);
-            *buttonPressed = true;
-        }
+            input |= ENGINE_INPUT_ROTATE;
         // Down arrow ***************************************************************
         // Down-button not debounced, so that it can be held down
         if(buttons.buttons[SDL_SCANCODE_DOWN])
         {
             buttons.buttons[SDL_SCANCODE_DOWN] = 0;
-            xSemaphoreGive(FallSignal);
+            input |= ENGINE_INPUT_DOWN;
         }
+        // Space ********************************************************************
+        if(bGameDebounceButton(buttons.buttons[SDL_SCANCODE_SPACE], &debounceSpace.lastState))
+            input |= ENGINE_INPUT_DROP;
         xSemaphoreGive(buttons.lock);
     }
-}
-
-static void changeTimerPeriod(TimerHandle_t timer, uint8_t level, int delay)
-{
-    if(timer)
-    {
-        if(level > 1)
-            xTimerChangePeriod(timer, pdMS_TO_TICKS(delay - (level * 40)), 0);
-        else
-            xTimerStart(timer, 0);
-    }
+    return input;
 }
 
 int iGameInit()
 {
-    /*Set seed for rand()*/
-    srand(time(NULL));
-
     /*Load sound waveforms*/
     tumSoundLoadUserSample(FALLING_SOUND);
     tumSoundLoadUserSample(GAME_OVER_SOUND);
@@ -701,12 +521,6 @@ int iGameInit()
         PRINT_ERROR("Failed to create draw signal");
         goto err_draw_signal;
     }
-    ScreenLock = xSemaphoreCreateMutex();
-    if(!ScreenLock)
-    {
-        PRINT_ERROR("Failed to create screen lock");
-        goto err_screen_lock;
-    }
 
     if(xTaskCreate(mainMenuTask, "MainMenuTask", mainGENERIC_STACK_SIZE, NULL, configMAX_PRIORITIES-3, &MainMenuTask) != pdPASS)
     {
@@ -762,8 +576,6 @@ int iGameInit()
     err_pause_task:
         vTaskDelete(MainMenuTask);
     err_main_menu_task:
-        vSemaphoreDelete(ScreenLock);
-    err_screen_lock:
         vSemaphoreDelete(DrawSignal);
     err_draw_signal:
         return -1;
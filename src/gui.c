@@ -11,6 +11,7 @@
 #include "input.h"
 
 #define FPS_AVERAGE_COUNT 50
+#define MAX_SQUARES (ROWS * COLS) ///< Maximum number of squares drawn in one batch
 #define CENTERED(x) (SCREEN_WIDTH/2 - x/2)
 
 // **********************************************************************************
@@ -62,6 +63,19 @@ static void drawGameModes(game_mode_t currentMode);
  */
 static void drawText(char *str, int16_t x, int16_t y, uint32_t color);
 
+/**
+ * @ingroup gui
+ * @brief Draw square images, as one batch from the atlas if it exists.
+ * @param[in] squares (const @ref image_handle_t []): Array containing the square images & the atlas.
+ * @param[in] images (const unsigned []): Index of the image of each square, e.g. #WALL_SQUARE.
+ * @param[in] positions (const @ref coord_t []): Top left corner of each square.
+ * @param[in] count (unsigned): Number of squares, at most #MAX_SQUARES.
+ */
+static void drawSquares(const image_handle_t squares[],
+                        const unsigned images[],
+                        const coord_t positions[],
+                        unsigned count);
+
 // **********************************************************************************
 // Menus & Screens ******************************************************************
 // **********************************************************************************
@@ -88,7 +102,7 @@ void vGUIDrawMainMenu(  game_mode_t mode,
     // Do not draw "PRESS S TO START" info rotation is selected.
     if(playerMode != NO_PLAYER && rotationMode != NO_ROTATION)
     {
-        if((playerMode == MULTI_PLAYER && isConnected) || playerMode == SINGLE_PLAYER)
+        if((playerMode == MULTI_PLAYER && isConnected) || playerMode == SINGLE_PLAYER || playerMode == AI_PLAYER)
         {
             str3 = malloc(sizeof("PRESS S TO START"));
             strcpy(str3, "PRESS S TO START");
@@ -290,8 +304,14 @@ void vGUIDrawStatic(const image_handle_t squares[], const score_t *score)
     tumFontSetSize((ssize_t) 12);
 
     // Wall between field & displays ************************************************
+    unsigned images[ROWS];
+    coord_t positions[ROWS];
     for(int row=0; row<ROWS; row++)
-        tumDrawImage(GREY_SQUARE, COLS * SQUARE_WIDTH, row*SQUARE_WIDTH);
+    {
+        images[row] = WALL_SQUARE;
+        positions[row] = (coord_t){ COLS * SQUARE_WIDTH, row*SQUARE_WIDTH };
+    }
+    drawSquares(squares, images, positions, ROWS);
 
     // Press Esc to pause ***********************************************************
     char *pauseStr = "Press Esc to pause";
@@ -312,7 +332,7 @@ void vGUIDrawStatic(const image_handle_t squares[], const score_t *score)
     drawText(str, x, y+=40, White); 
 
     // Lines ************************************************************************
-    sprintf(str, "LINES:  %d  ", score->rows);
+    sprintf(str, "LINES:  %u  ", score->rows);
     drawText(str, x, y+=40, White);
     
     // Next tetromino ***************************************************************
@@ -415,24 +435,24 @@ bool bGUIDrawPlayerModeSelection(player_mode_t *playerMode)
     tumFontSetSize((ssize_t) 20);
     
     // Player mode selection ********************************************************
-    char *strs[2] = {"1 PLAYER", "2 PLAYERS"};
+    char *strs[3] = {"1 PLAYER", "2 PLAYERS", "AI"};
     int width = 0, y = 100;
     bool playerModeChanged = false;
-    static uint32_t strColors[2] = { 0 };
+    static uint32_t strColors[3] = { 0 };
 
-    for(int i=0; i<2; i++)
+    for(int i=0; i<3; i++)
     {
         tumGetTextSize(strs[i], &width, NULL);
 
         // Boundaries
-        coord_t lowBounds   = {SCREEN_WIDTH * (i+1)/3 - width/2, y - 5};
-        coord_t highBounds  = {SCREEN_WIDTH * (i+1)/3 + width/2, y + 20};
+        coord_t lowBounds   = {SCREEN_WIDTH * (i+1)/4 - width/2, y - 5};
+        coord_t highBounds  = {SCREEN_WIDTH * (i+1)/4 + width/2, y + 20};
 
         if(bGUIPushButton(lowBounds, highBounds))
         {
             *playerMode = i+1;
             playerModeChanged = true;
-            for(int j=0; j<2; j++) strColors[j] = Black;
+            for(int j=0; j<3; j++) strColors[j] = Black;
             strColors[i] = White;
         }
         drawText(strs[i], lowBounds.x, y, strColors[i]);
@@ -561,41 +581,65 @@ void drawUserNameSelection(score_t *score, char *lastUserName)
 // **********************************************************************************
 void vGUIDrawTetromino(const tetromino_t *tetromino, const image_handle_t squares[])
 {
-    for(int row=0; row<FIGURE_SIZE; row++)
-        for(int col=0; col<FIGURE_SIZE; col++)
-            if(tetromino->shape[row][col] != 0)
-                tumDrawLoadedImage
-                (   
-                    squares[tetromino->color-1],
-                    (tetromino->position.x+col)*SQUARE_WIDTH, 
-                    (tetromino->position.y+row)*SQUARE_WIDTH
-                );
+    unsigned images[TETROMINO_SQUARES];
+    coord_t positions[TETROMINO_SQUARES];
+    for(int i=0; i<tetromino->shape->count; i++)
+    {
+        images[i] = tetromino->color-1;
+        positions[i] = (coord_t)
+        {
+            (tetromino->position.x + tetromino->shape->squares[i].x)*SQUARE_WIDTH, 
+            (tetromino->position.y + tetromino->shape->squares[i].y)*SQUARE_WIDTH
+        };
+    }
+    drawSquares(squares, images, positions, tetromino->shape->count);
+}
+
+void vGUIDrawGhost(const tetromino_t *tetromino, const board_t *landed)
+{
+    int y = tetromino->position.y + iLogicDropDistance(tetromino->shape, tetromino->position, landed);
+    for(int i=0; i<tetromino->shape->count; i++)
+        checkDraw(  tumDrawBox
+                    (
+                        (tetromino->position.x + tetromino->shape->squares[i].x)*SQUARE_WIDTH,
+                        (y + tetromino->shape->squares[i].y)*SQUARE_WIDTH,
+                        SQUARE_WIDTH, SQUARE_WIDTH, GHOST_COLOR
+                    ), __FUNCTION__);
 }
 
-void vGUIDrawLanded(const color_t landed[ROWS][COLS], const image_handle_t squares[])
+void vGUIDrawLanded(const board_t *landed, const image_handle_t squares[])
 {
+    unsigned images[MAX_SQUARES];
+    coord_t positions[MAX_SQUARES];
+    unsigned count = 0;
     for(int row=0; row<ROWS; row++)
+    {
+        if(!landed->rows[row])
+            continue;
         for(int col=0; col<COLS; col++)
-            if(landed[row][col] != EMPTY_SPACE)
-                tumDrawLoadedImage
-                ( 
-                    squares[landed[row][col]-1],
-                    col*SQUARE_WIDTH,
-                    SCREEN_HEIGHT - (row+1)* SQUARE_WIDTH
-                );
+            if(landed->rows[row] & (1 << col))
+            {
+                images[count] = landed->colors[row][col]-1;
+                positions[count++] = (coord_t){ col*SQUARE_WIDTH, SCREEN_HEIGHT - (row+1)* SQUARE_WIDTH };
+            }
+    }
+    drawSquares(squares, images, positions, count);
 }
 
 void vGUIDrawNextTetromino(const tetromino_t *tetromino, const image_handle_t squares[])
 {
-    for(int row=0; row<FIGURE_SIZE; row++)
-        for(int col=0; col<FIGURE_SIZE; col++)
-            if(tetromino->shape[row][col] != 0)
-                tumDrawLoadedImage
-                (   
-                    squares[tetromino->color-1],
-                    (COLS+col)*SQUARE_WIDTH + 105, 
-                    row*SQUARE_WIDTH + 250
-                );
+    unsigned images[TETROMINO_SQUARES];
+    coord_t positions[TETROMINO_SQUARES];
+    for(int i=0; i<tetromino->shape->count; i++)
+    {
+        images[i] = tetromino->color-1;
+        positions[i] = (coord_t)
+        {
+            (COLS + tetromino->shape->squares[i].x)*SQUARE_WIDTH + 105, 
+            tetromino->shape->squares[i].y*SQUARE_WIDTH + 250
+        };
+    }
+    drawSquares(squares, images, positions, tetromino->shape->count);
 }
 
 // **********************************************************************************
@@ -606,6 +650,20 @@ void drawText(char *str, int16_t x, int16_t y, uint32_t color)
     checkDraw(tumDrawText(str, x, y, color), __FUNCTION__);
 }
 
+void drawSquares(   const image_handle_t squares[],
+                    const unsigned images[],
+                    const coord_t positions[],
+                    unsigned count)
+{
+    if(squares[SQUARE_ATLAS])
+    {
+        checkDraw(tumDrawImageBatch(squares[SQUARE_ATLAS], images, positions, count), __FUNCTION__);
+        return;
+    }
+    for(unsigned i=0; i<count; i++)
+        checkDraw(tumDrawLoadedImage(squares[images[i]], positions[i].x, positions[i].y), __FUNCTION__);
+}
+
 void checkDraw(uint8_t status, const char *msg)
 {
     if(status)
@@ -666,6 +724,8 @@ void vGUISetImageHandle(image_handle_t squares[])
     squares[TETRIS_RED-1]           = tumDrawLoadImage(RED_SQUARE); 
     squares[TETRIS_LIGHT_BLUE-1]    = tumDrawLoadImage(LIGHT_BLUE_SQUARE); 
     squares[TETRIS_PURPLE-1]        = tumDrawLoadImage(PURPLE_SQUARE); 
+    squares[WALL_SQUARE]            = tumDrawLoadImage(GREY_SQUARE);
+    squares[SQUARE_ATLAS]           = tumDrawCreateAtlas(squares, NUMBER_OF_SQUARE_IMAGES);
 }
 
 
@@ -1,20 +1,124 @@
 #include "logic.h"
 
+/**
+ * @ingroup logic
+ * @brief Rotate @p x to the left by @p k bits.
+ */
+#define ROTL32(x, k) (((x) << (k)) | ((x) >> (32 - (k))))
+
+/**
+ * @name Placement Search
+ * A state of the search is a Tetromino's position, rotation & whether it still has its spawn shape,
+ * packed into one index.
+ * @{
+ */
+#define STATE_X_OFFSET FIGURE_SIZE                  ///< Offset of the x-coordinate, since it can be negative
+#define STATE_COLS (COLS + FIGURE_SIZE)             ///< Number of possible x-coordinates
+/// Number of possible states
+#define STATE_COUNT (2 * NUMBER_OF_ROTATIONS * ROWS * STATE_COLS)
+/// Pack a state into an index
+#define STATE_INDEX(x, y, rotation, spawn) \
+    ((((spawn) * NUMBER_OF_ROTATIONS + (rotation)) * ROWS + (y)) * STATE_COLS + (x) + STATE_X_OFFSET)
+///@}
+
+// **********************************************************************************
+// Shape Table **********************************************************************
+// **********************************************************************************
+/// @cond
+#define MIN4(a, b, c, d) ((a) < (b) ? ((a) < (c) ? ((a) < (d) ? (a) : (d)) : ((c) < (d) ? (c) : (d))) \
+                                    : ((b) < (c) ? ((b) < (d) ? (b) : (d)) : ((c) < (d) ? (c) : (d))))
+#define MAX4(a, b, c, d) (-MIN4(-(a), -(b), -(c), -(d)))
+/// @endcond
+
+/**
+ * @ingroup logic
+ * @brief Build a @ref shape_t from the (column, row) offsets of its four squares.
+ * 
+ * The bounding box is computed at compile time.
+ */
+#define SHAPE(x0, y0, x1, y1, x2, y2, x3, y3)                      \
+    {                                                               \
+        TETROMINO_SQUARES,                                          \
+        { {x0, y0}, {x1, y1}, {x2, y2}, {x3, y3} },                 \
+        { MIN4(x0, x1, x2, x3), MIN4(y0, y1, y2, y3) },             \
+        { MAX4(x0, x1, x2, x3), MAX4(y0, y1, y2, y3) }              \
+    }
+
+/**
+ * @ingroup logic
+ * @brief Shape table for a rotation, that looks the same when it is spawned.
+ */
+#define SAME_AT_SPAWN(shape) { shape, shape }
+
+/**
+ * @ingroup logic
+ * @brief Precomputed shapes, indexed by type, rotation & whether it is the spawn variant.
+ * 
+ * The #NO_TYPE entries are empty, therefore they never collide with anything.
+ */
+static const shape_t shapes[I+1][NUMBER_OF_ROTATIONS][2] =
+{
+    [NO_TYPE] = { { { 0 } } },
+    [S] = 
+    {
+        SAME_AT_SPAWN(SHAPE(2,0, 3,0, 1,1, 2,1)),
+        SAME_AT_SPAWN(SHAPE(2,0, 2,1, 3,1, 3,2)),
+        SAME_AT_SPAWN(SHAPE(2,0, 3,0, 1,1, 2,1)),
+        SAME_AT_SPAWN(SHAPE(2,0, 2,1, 3,1, 3,2))
+    },
+    [Z] = 
+    {
+        SAME_AT_SPAWN(SHAPE(1,0, 2,0, 2,1, 3,1)),
+        SAME_AT_SPAWN(SHAPE(3,0, 2,1, 3,1, 2,2)),
+        SAME_AT_SPAWN(SHAPE(1,0, 2,0, 2,1, 3,1)),
+        SAME_AT_SPAWN(SHAPE(3,0, 2,1, 3,1, 2,2))
+    },
+    [J] = 
+    {
+        SAME_AT_SPAWN(SHAPE(2,0, 2,1, 1,2, 2,2)),
+        SAME_AT_SPAWN(SHAPE(1,0, 1,1, 2,1, 3,1)),
+        SAME_AT_SPAWN(SHAPE(2,0, 3,0, 2,1, 2,2)),
+        SAME_AT_SPAWN(SHAPE(1,1, 2,1, 3,1, 3,2))
+    },
+    [L] = 
+    {
+        SAME_AT_SPAWN(SHAPE(2,0, 2,1, 2,2, 3,2)),
+        { SHAPE(1,1, 2,1, 3,1, 1,2), SHAPE(1,0, 2,0, 3,0, 1,1) },
+        SAME_AT_SPAWN(SHAPE(1,0, 2,0, 2,1, 2,2)),
+        SAME_AT_SPAWN(SHAPE(3,0, 1,1, 2,1, 3,1))
+    },
+    [T] = 
+    {
+        SAME_AT_SPAWN(SHAPE(2,0, 1,1, 2,1, 3,1)),
+        SAME_AT_SPAWN(SHAPE(2,0, 2,1, 3,1, 2,2)),
+        { SHAPE(1,1, 2,1, 3,1, 2,2), SHAPE(1,0, 2,0, 3,0, 2,1) },
+        SAME_AT_SPAWN(SHAPE(2,0, 1,1, 2,1, 2,2))
+    },
+    [O] = 
+    {
+        SAME_AT_SPAWN(SHAPE(2,0, 3,0, 2,1, 3,1)),
+        SAME_AT_SPAWN(SHAPE(2,0, 3,0, 2,1, 3,1)),
+        SAME_AT_SPAWN(SHAPE(2,0, 3,0, 2,1, 3,1)),
+        SAME_AT_SPAWN(SHAPE(2,0, 3,0, 2,1, 3,1))
+    },
+    [I] = 
+    {
+        SAME_AT_SPAWN(SHAPE(2,0, 2,1, 2,2, 2,3)),
+        { SHAPE(0,2, 1,2, 2,2, 3,2), SHAPE(0,0, 1,0, 2,0, 3,0) },
+        SAME_AT_SPAWN(SHAPE(2,0, 2,1, 2,2, 2,3)),
+        SAME_AT_SPAWN(SHAPE(0,2, 1,2, 2,2, 3,2))
+    }
+};
+
 // **********************************************************************************
 // Forward Declarations *************************************************************
 // **********************************************************************************
 /**
  * @ingroup logic
- * @brief Set a Tetromino's type.
- *
- * Randomly take one of the 7 possible tetromino types 
- * and reduce the number of possible types, 
- * so that every type is selected once for every seven new tetrominos.
- * @param[out] tetromino ( @ref tetromino_t *): Tetromino to set type for.
- * @param[inout] types ( @ref tetromino_type_t []): Array of tetromino types.
- * @param[inout] index (int*): Current index of the types array.
+ * @brief Append a new, shuffled bag of all 7 types to the ring buffer of @p bag.
+ * @param[inout] bag ( @ref bag_t *): The bag.
  */
-static void setTetrominoType(tetromino_t *tetromino, tetromino_type_t types[], int *index);
+static void refillBag(bag_t *bag);
 
 /**
  * @ingroup logic
@@ -26,31 +130,103 @@ static void increaseScore(score_t *score, uint8_t rowsAmount);
 
 /**
  * @ingroup logic
- * @brief Set the shape array of the tetromino, depending on the rotation & type.
- * @param[in] color ( @ref color_t): Color of the tetromino.
- * @param[in] type ( @ref tetromino_type_t): Type of the tetromino. 
- * @param[in] shape ( @ref color_t [][]): Shape array to set.
- * @param[in] rotateAmount (int): Amount of rotation for the shape. 
- * @param[in] init (bool): For some Tetrominos, the shape is set differently at the start. 
+ * @brief Update the cached column heights & the number of holes after rows were cleared.
+ * @param[inout] landed ( @ref board_t *): Board of landed Tetrominos. 
+ * @param[in] rowsAmount (uint8_t): Number of rows cleared. 
+ */
+static void updateHeights(board_t *landed, uint8_t rowsAmount);
+
+/**
+ * @ingroup logic
+ * @brief Get the Zobrist hash of the occupied squares of one row.
+ * @param[in] row (int): Index of the row.
+ * @param[in] mask (uint16_t): Occupancy mask of the row.
+ * @return (uint64_t): XOR of the keys of the occupied squares.
  */
-static void setTetrominoShape(  color_t color, 
-                                tetromino_type_t type, 
-                                color_t shape[FIGURE_SIZE][FIGURE_SIZE],
-                                int rotateAmount, 
-                                bool init);
+static uint64_t rowHash(int row, uint16_t mask);
+
+/**
+ * @ingroup logic
+ * @brief Get the squares a shape covers as row masks, to tell apart placements.
+ * @param[in] shape (const @ref shape_t *): The shape.
+ * @param[in] position ( @ref coord_t): Position of the shape.
+ * @return (uint64_t): The masks of the 4 rows starting at the shape's top row, packed into one number.
+ */
+static uint64_t footprint(const shape_t *shape, coord_t position);
 
 // **********************************************************************************
 // Function Definitions *************************************************************
 // **********************************************************************************
-void vLogicInitTetromino(tetromino_t *tetromino, tetromino_type_t types[], int *index, player_mode_t playerMode)
+void vLogicSeedRandom(rng_t *rng, uint32_t seed)
+{
+    // splitmix32
+    for(int i=0; i<4; i++)
+    {
+        uint32_t z = (seed += 0x9E3779B9);
+        z = (z ^ (z >> 16)) * 0x85EBCA6B;
+        z = (z ^ (z >> 13)) * 0xC2B2AE35;
+        rng->s[i] = z ^ (z >> 16);
+    }
+}
+
+uint64_t ullLogicHashKey(uint64_t x)
+{
+    // splitmix64
+    x += 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+uint32_t ulLogicRandom(rng_t *rng)
+{
+    // xoshiro128**
+    uint32_t *s = rng->s;
+    uint32_t result = ROTL32(s[1] * 5, 7) * 9;
+    uint32_t t = s[1] << 9;
+
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = ROTL32(s[3], 11);
+
+    return result;
+}
+
+void vLogicInitBag(bag_t *bag, uint32_t seed)
+{
+    *bag = (bag_t){ 0 };
+    vLogicSeedRandom(&bag->rng, seed);
+}
+
+tetromino_type_t eLogicBagPeek(bag_t *bag, int depth)
+{
+    if(depth > BAG_MAX_PREVIEW)
+        depth = BAG_MAX_PREVIEW;
+    while(bag->count <= depth)
+        refillBag(bag);
+    return bag->types[(bag->head + depth) & (BAG_CAPACITY-1)];
+}
+
+tetromino_type_t eLogicBagNext(bag_t *bag)
+{
+    tetromino_type_t type = eLogicBagPeek(bag, 0);
+    bag->head = (bag->head + 1) & (BAG_CAPACITY-1);
+    bag->count--;
+    return type;
+}
+
+void vLogicInitTetromino(tetromino_t *tetromino, bag_t *bag, player_mode_t playerMode, rng_t *rng)
 {
     // Set Tetromino type
-    if(playerMode == SINGLE_PLAYER)
-        setTetrominoType(tetromino, types, index);
+    if(playerMode != MULTI_PLAYER)
+        tetromino->type = eLogicBagNext(bag);
     // Set Tetromino rotation
-    tetromino->rotation = (rand() % 3);
+    tetromino->rotation = (ulLogicRandom(rng) % 3);
     // Set Tetromino color
-    tetromino->color = (rand() % NUMBER_OF_TETRIS_COLORS) + 1;
+    tetromino->color = (ulLogicRandom(rng) % NUMBER_OF_TETRIS_COLORS) + 1;
 
     // Init positions & newPositions
     tetromino->position.y = 0;
@@ -61,86 +237,88 @@ void vLogicInitTetromino(tetromino_t *tetromino, tetromino_type_t types[], int *
         tetromino->position.x = COLS/2 - 3;
     tetromino->newPosition = tetromino->position;
     
-    // Set the shape array
-    setTetrominoShape(tetromino->color, tetromino->type, tetromino->shape,tetromino->rotation, true);
+    // Set the shape
+    tetromino->shape = pxLogicGetShape(tetromino->type, tetromino->rotation, true);
 }
 
-static void setTetrominoType(tetromino_t *tetromino, tetromino_type_t types[], int *index)
+static void refillBag(bag_t *bag)
 {
-    // If the first element of the sequence has no type,
-    // this means that the sequence is empty & a new one needs to be generated
-    // Therefore, initialize each element of the array with one of the possible Tetromino types
-    if(types[0] == NO_TYPE)
+    // Shuffle all types with Fisher-Yates
+    tetromino_type_t types[NUMBER_OF_TYPES] = { S, Z, J, L, T, O, I };
+    for(int i=NUMBER_OF_TYPES-1; i>0; i--)
     {
-        *index = 7;
-        for(int i=0; i<7; i++)
-            types[i] = i+1;
+        int j = ulLogicRandom(&bag->rng) % (i+1);
+        tetromino_type_t tmp = types[i];
+        types[i] = types[j];
+        types[j] = tmp;
     }
 
-    // Generate a number between 1 and the sequence index
-    int num = (rand() % (*index)) + 1;
+    // Append them behind the upcoming types
+    for(int i=0; i<NUMBER_OF_TYPES; i++)
+        bag->types[(bag->head + bag->count + i) & (BAG_CAPACITY-1)] = types[i];
+    bag->count += NUMBER_OF_TYPES;
+}
 
-    // Set the tetrominos type to the sequences entry at the random number
-    tetromino->type = types[num-1];
 
-    // Remove the element at the randomly generated number from the sequence
-    if(num == 7)
-        types[num-1] = NO_TYPE;
-    else
+const shape_t *pxLogicGetShape(tetromino_type_t type, int rotation, bool spawn)
+{
+    return &shapes[type][rotation][spawn];
+}
+
+bool bLogicCheckMove(const shape_t *newShape, coord_t newPosition, const board_t *landed)
+{
+    if(!newShape->count)
+        return true;
+    // Collision on the side borders & the ground
+    if( newPosition.x + newShape->min.x < 0 || 
+        newPosition.x + newShape->max.x >= COLS ||
+        newPosition.y + newShape->max.y >= ROWS)
+        return false;
+    // Collision with the landed tetrominos
+    for(int i=0; i<newShape->count; i++)
     {
-        for(int i=num-1; i<6; i++)
-        {
-            if(types[i+1] != NO_TYPE)
-            {
-                types[i] = types[i+1];
-                types[i+1] = NO_TYPE;
-            }
-            else
-                types[i] = NO_TYPE;
-        }
+        int row = newPosition.y + newShape->squares[i].y;
+        int col = newPosition.x + newShape->squares[i].x;
+        if(landed->rows[ROWS-1 - row] & (1 << col))
+            return false;
     }
-    
-    // Lower the sequence index by one
-    *index -= 1;
+    return true;
 }
 
-
-bool bLogicCheckMove(const color_t newShape[FIGURE_SIZE][FIGURE_SIZE], coord_t newPosition, const color_t landed[ROWS][COLS])
+int iLogicDropDistance(const shape_t *shape, coord_t position, const board_t *landed)
 {
-    for(int row=0; row<FIGURE_SIZE; row++)
+    if(!shape->count)
+        return 0;
+    
+    // Distance to the ground
+    int distance = ROWS-1 - (position.y + shape->max.y);
+    for(int i=0; i<shape->count; i++)
     {
-        for(int col=0; col<FIGURE_SIZE; col++)
+        int row = ROWS-1 - (position.y + shape->squares[i].y);
+        int col = position.x + shape->squares[i].x;
+        // The square is below an overhang, so the column height does not tell where it lands
+        if(row < landed->heights[col])
         {
-            if(newShape[row][col]!= EMPTY_SPACE)
-            {
-                // Collision on the ground
-                if(row + newPosition.y >= ROWS) 
-                    return false;
-                // Collision on the left border
-                if(col + newPosition.x < 0)
-                    return false;
-                // Collision on the right border
-                if(col + newPosition.x >= COLS) 
-                    return false;
-                // Collision with the landed tetrominos
-                if(landed   [ROWS-1 - (row + newPosition.y)]
-                            [col + newPosition.x] 
-                            != EMPTY_SPACE)
-                    return false;
-            }
+            distance = 0;
+            coord_t down = { position.x, position.y + 1 };
+            for(; bLogicCheckMove(shape, down, landed); down.y++)
+                distance++;
+            return distance;
         }
+        if(row - landed->heights[col] < distance)
+            distance = row - landed->heights[col];
     }
-    return true;
+    return distance;
 }
 
-bool bLogicCheckGameOver(const tetromino_t *tetromino, const color_t landed[ROWS][COLS])
+bool bLogicCheckGameOver(const tetromino_t *tetromino, const board_t *landed)
 {
     // If the y-position of the current tetromino is 0
     // & a collision has been detected, the game is over
     return (tetromino->position.y == 0 && !bLogicCheckMove(tetromino->shape, tetromino->position, landed));
 }
 
-void vLogicUpdateXCoord(tetromino_t *tetromino, const color_t landed[ROWS][COLS], int pressedButton)
+void vLogicUpdateXCoord(tetromino_t *tetromino, const board_t *landed, int pressedButton)
 {
     if(pressedButton == LEFT_PRESSED)
     {
@@ -162,7 +340,7 @@ void vLogicUpdateXCoord(tetromino_t *tetromino, const color_t landed[ROWS][COLS]
     }
 }
 
-bool bLogicUpdateYCoord(tetromino_t *tetromino, const color_t landed[ROWS][COLS])
+bool bLogicUpdateYCoord(tetromino_t *tetromino, const board_t *landed)
 {
     tetromino->newPosition.y++;
     if(bLogicCheckMove(tetromino->shape, tetromino->newPosition, landed))
@@ -178,77 +356,210 @@ bool bLogicUpdateYCoord(tetromino_t *tetromino, const color_t landed[ROWS][COLS]
 }
 
 
-void vLogicRotate(tetromino_t *tetromino, const color_t landed[ROWS][COLS], rotation_t rotationMode)
+void vLogicRotate(tetromino_t *tetromino, const board_t *landed, rotation_t rotationMode)
 {
     // Increase/decrease Tetromino's rotation counter, depending on the rotation mode
     int rotation = tetromino->rotation;
     if(rotationMode == LEFT)
-    {
-        if(tetromino->rotation > 0) rotation--;
-        else rotation = 3;
-    }
-    if(rotationMode == RIGHT) rotation++;
+        rotation = (rotation + NUMBER_OF_ROTATIONS - 1) % NUMBER_OF_ROTATIONS;
+    if(rotationMode == RIGHT)
+        rotation = (rotation + 1) % NUMBER_OF_ROTATIONS;
 
-    // Set Tetrominos newShape, that it have after the rotation
-    setTetrominoShape(tetromino->color, tetromino->type, tetromino->newShape, rotation, false);
+    // Get the shape the Tetromino would have after the rotation
+    const shape_t *newShape = pxLogicGetShape(tetromino->type, rotation, false);
 
     // Check if the new shape collides with anything
-    if(bLogicCheckMove(tetromino->newShape, tetromino->position, landed))
+    if(bLogicCheckMove(newShape, tetromino->position, landed))
     {
-        // If so, set the new shape as shape for the Tetromino
-        for(int row=0; row<FIGURE_SIZE; row++)
-            for(int col=0; col<FIGURE_SIZE; col++)
-                tetromino->shape[row][col] = tetromino->newShape[row][col];
-        // Set new rotation value
+        // If not, set the new shape & rotation for the Tetromino
+        tetromino->shape = newShape;
         tetromino->rotation = rotation;        
     }
 }
 
-void vLogicAddToLanded(const tetromino_t *tetromino, color_t landed[ROWS][COLS])
+int iLogicGetPlacements(const tetromino_t *tetromino, const board_t *landed, rotation_t rotationMode, placement_t placements[], int maxPlacements)
 {
-    for(int row=0; row<FIGURE_SIZE; row++)
-        for(int col=0; col<FIGURE_SIZE; col++)
-            if(tetromino->shape[row][col] != EMPTY_SPACE)
+    uint32_t visited[(STATE_COUNT + 31) / 32] = { 0 };
+    uint16_t queue[STATE_COUNT];
+    uint64_t footprints[MAX_PLACEMENTS];
+    int head = 0, tail = 0, count = 0;
+
+    if(maxPlacements > MAX_PLACEMENTS)
+        maxPlacements = MAX_PLACEMENTS;
+    
+    if(!tetromino->shape->count || !bLogicCheckMove(tetromino->shape, tetromino->position, landed))
+        return 0;
+
+    // The rotation direction is fixed by the rotation mode, like in vLogicRotate()
+    int rotationStep = 0;
+    if(rotationMode == LEFT)
+        rotationStep = NUMBER_OF_ROTATIONS - 1;
+    if(rotationMode == RIGHT)
+        rotationStep = 1;
+
+    bool spawn = tetromino->shape == pxLogicGetShape(tetromino->type, tetromino->rotation, true);
+    int start = STATE_INDEX(tetromino->position.x, tetromino->position.y, tetromino->rotation, spawn);
+    visited[start / 32] |= 1u << (start % 32);
+    queue[tail++] = start;
+
+    while(head < tail && count < maxPlacements)
+    {
+        // Unpack the state
+        int state = queue[head++];
+        coord_t position = { state % STATE_COLS - STATE_X_OFFSET, (state / STATE_COLS) % ROWS };
+        int rotation = (state / (STATE_COLS * ROWS)) % NUMBER_OF_ROTATIONS;
+        spawn = state / (STATE_COLS * ROWS * NUMBER_OF_ROTATIONS);
+        const shape_t *shape = pxLogicGetShape(tetromino->type, rotation, spawn);
+
+        // Left, right, rotate & down
+        const int dx[] = { -1, 1, 0, 0 };
+        const int dy[] = { 0, 0, 0, 1 };
+        for(int move=0; move<4; move++)
+        {
+            coord_t newPosition = { position.x + dx[move], position.y + dy[move] };
+            int newRotation = rotation;
+            bool newSpawn = spawn;
+            if(move == 2)
             {
-                // The landed array's rows start at the bottom of the window
-                // Therefore, the Tetromino's y-coord needs to be subtracted
-                uint16_t rowIndex = ROWS-1 - (row + tetromino->position.y);
-                uint16_t colIndex = col + tetromino->position.x;
-                landed[rowIndex][colIndex] = tetromino->shape[row][col]; 
+                if(!rotationStep)
+                    continue;
+                newRotation = (rotation + rotationStep) % NUMBER_OF_ROTATIONS;
+                newSpawn = false;
             }
+            const shape_t *newShape = pxLogicGetShape(tetromino->type, newRotation, newSpawn);
+            if(!bLogicCheckMove(newShape, newPosition, landed))
+            {
+                // The Tetromino cannot move down, so it lands here
+                if(move == 3)
+                {
+                    uint64_t key = footprint(shape, position);
+                    int top = position.y + shape->min.y;
+                    int i = 0;
+                    while(i < count && (footprints[i] != key || 
+                                        placements[i].position.y + placements[i].shape->min.y != top))
+                        i++;
+                    if(i == count)
+                    {
+                        footprints[count] = key;
+                        placements[count++] = (placement_t){ position, rotation, shape };
+                    }
+                }
+                continue;
+            }
+            int next = STATE_INDEX(newPosition.x, newPosition.y, newRotation, newSpawn);
+            if(visited[next / 32] & (1u << (next % 32)))
+                continue;
+            visited[next / 32] |= 1u << (next % 32);
+            queue[tail++] = next;
+        }
+    }
+    return count;
 }
 
-bool vLogicRowFull(color_t landed[ROWS][COLS], score_t *score)
+void vLogicAddToLanded(const tetromino_t *tetromino, board_t *landed)
 {
-    uint8_t rowsAmount = 0;
+    for(int i=0; i<tetromino->shape->count; i++)
+    {
+        // The board's rows start at the bottom of the window
+        // Therefore, the Tetromino's y-coord needs to be subtracted
+        uint16_t rowIndex = ROWS-1 - (tetromino->shape->squares[i].y + tetromino->position.y);
+        uint16_t colIndex = tetromino->shape->squares[i].x + tetromino->position.x;
+        landed->rows[rowIndex] |= 1 << colIndex;
+        landed->colors[rowIndex][colIndex] = tetromino->color; 
+        landed->hash ^= rowHash(rowIndex, 1 << colIndex);
 
-    // If there is one empty space left in a row, rowFull is set to false
+        // Either the square fills a hole, or the empty squares between it & the column's top become holes
+        if(rowIndex < landed->heights[colIndex])
+            landed->holes--;
+        else
+        {
+            landed->holes += rowIndex - landed->heights[colIndex];
+            landed->heights[colIndex] = rowIndex + 1;
+        }
+        if(++landed->rowFill[rowIndex] == COLS)
+            landed->fullRows |= 1 << rowIndex;
+    }
+}
+
+uint16_t usLogicRowFull(board_t *landed, score_t *score)
+{
+    uint16_t clearedRows = landed->fullRows;
+    if(!clearedRows)
+        return 0;
+
+    // Copy every row, that is not full, straight to its final row
+    int target = 0;
     for(int row=0; row<ROWS; row++)
     {
-        bool rowFull = true;
-        for(int col=0; col<COLS; col++)
-            if(landed[row][col] == EMPTY_SPACE)
-            {
-                rowFull = false;
-                break;
-            }
-        // If the row is indeed full, the rows above are shifted down
-        if(rowFull)
+        if(clearedRows & (1 << row))
         {
-            for(int rowAbove = row; rowAbove<ROWS-1; rowAbove++)
-                for(int col=0; col<COLS; col++)
-                    landed[rowAbove][col] = landed[rowAbove+1][col];
-            rowsAmount++;
-            row--;
+            landed->hash ^= rowHash(row, FULL_ROW);
+            continue;
         }
+        if(target != row)
+        {
+            landed->hash ^= rowHash(row, landed->rows[row]) ^ rowHash(target, landed->rows[row]);
+            landed->rows[target] = landed->rows[row];
+            landed->rowFill[target] = landed->rowFill[row];
+            memcpy(landed->colors[target], landed->colors[row], sizeof(landed->colors[0]));
+        }
+        target++;
     }
     
-    if(rowsAmount)
+    // The rows on top are empty after compacting
+    uint8_t rowsAmount = ROWS - target;
+    memset(&landed->rows[target], 0, rowsAmount * sizeof(landed->rows[0]));
+    memset(&landed->rowFill[target], 0, rowsAmount * sizeof(landed->rowFill[0]));
+    memset(landed->colors[target], NO_COLOR, rowsAmount * sizeof(landed->colors[0]));
+    landed->fullRows = 0;
+
+    updateHeights(landed, rowsAmount);
+    increaseScore(score, rowsAmount);
+    return clearedRows;
+}
+
+static void updateHeights(board_t *landed, uint8_t rowsAmount)
+{
+    int filled = 0;
+    for(int row=0; row<ROWS; row++)
+        filled += landed->rowFill[row];
+
+    int heightSum = 0;
+    for(int col=0; col<COLS; col++)
     {
-        increaseScore(score, rowsAmount);
-        return true;
+        // A column loses one row per cleared row, unless its top was cleared as well
+        int height = landed->heights[col] - rowsAmount;
+        if(height < 0)
+            height = 0;
+        while(height > 0 && !(landed->rows[height-1] & (1 << col)))
+            height--;
+        landed->heights[col] = height;
+        heightSum += height;
+    }
+    
+    // Every square below a column's top, that is not occupied, is a hole
+    landed->holes = heightSum - filled;
+}
+
+static uint64_t rowHash(int row, uint16_t mask)
+{
+    uint64_t hash = 0;
+    for(int col=0; mask; col++, mask >>= 1)
+        if(mask & 1)
+            hash ^= ullLogicHashKey(row * COLS + col);
+    return hash;
+}
+
+static uint64_t footprint(const shape_t *shape, coord_t position)
+{
+    uint64_t key = 0;
+    for(int i=0; i<shape->count; i++)
+    {
+        int row = shape->squares[i].y - shape->min.y;
+        int col = position.x + shape->squares[i].x;
+        key |= (uint64_t)1 << (row * 16 + col);
     }
-    return false;  
+    return key;
 }
 
 static void increaseScore(score_t *score, uint8_t rowsAmount)
@@ -280,265 +591,3 @@ static void increaseScore(score_t *score, uint8_t rowsAmount)
         score->level++;
 }
 
-
-static void setTetrominoShape(  color_t color, 
-                                tetromino_type_t type,
-                                color_t shape[FIGURE_SIZE][FIGURE_SIZE],
-                                int rotateAmount, 
-                                bool init)
-{
-
-    for(int row=0; row<FIGURE_SIZE; row++)
-        for(int col=0; col<FIGURE_SIZE; col++)
-            shape[row][col] = 0;
-    
-    switch(type)
-    {
-        // * S-Tetromino *
-        case S:
-            switch(rotateAmount%4)
-            {
-                case 0:
-                    shape[0][2] = color;
-                    shape[0][3] = color;
-                    shape[1][1] = color;
-                    shape[1][2] = color;
-                    break;
-                case 1:
-                    shape[0][2] = color;
-                    shape[1][2] = color;
-                    shape[1][3] = color;
-                    shape[2][3] = color;
-                    break;
-                case 2:
-                    shape[0][2] = color;
-                    shape[0][3] = color;
-                    shape[1][1] = color;
-                    shape[1][2] = color;
-                    break;
-                case 3:
-                    shape[0][2] = color;
-                    shape[1][2] = color;
-                    shape[1][3] = color;
-                    shape[2][3] = color;
-                    break;
-                default:
-                    break;
-            }
-            break;
-        // * Z-Tetromino *
-        case Z:
-            switch(rotateAmount%4)
-            {
-                case 0:
-                    shape[0][1] = color;
-                    shape[0][2] = color;
-                    shape[1][2] = color;
-                    shape[1][3] = color;
-                    break;
-                case 1:
-                    shape[0][3] = color;
-                    shape[1][2] = color;
-                    shape[1][3] = color;
-                    shape[2][2] = color;
-                    break;
-                case 2:
-                    shape[0][1] = color;
-                    shape[0][2] = color;
-                    shape[1][2] = color;
-                    shape[1][3] = color;
-                    break;
-                case 3:
-                    shape[0][3] = color;
-                    shape[1][2] = color;
-                    shape[1][3] = color;
-                    shape[2][2] = color;
-                    break;
-                default:
-                    break;
-            }
-            break;
-        // * J-Tetromino *
-        case J:
-            switch(rotateAmount%4)
-            {
-                case 0:
-                    shape[0][2] = color;
-                    shape[1][2] = color;
-                    shape[2][1] = color;
-                    shape[2][2] = color;
-                    break;
-                case 1:
-                    shape[0][1] = color;
-                    shape[1][1] = color;
-                    shape[1][2] = color;
-                    shape[1][3] = color;
-                    break;
-                case 2:
-                    shape[0][2] = color;
-                    shape[0][3] = color;
-                    shape[1][2] = color;
-                    shape[2][2] = color;
-                    break;
-                case 3:
-                    if(init)
-                    {
-                        shape[1][1] = color;
-                        shape[1][2] = color;
-                        shape[1][3] = color;
-                        shape[2][3] = color;
-                    }
-                    else
-                    {
-                        shape[1][1] = color;
-                        shape[1][2] = color;
-                        shape[1][3] = color;
-                        shape[2][3] = color;
-                    }
-                    break;
-                default:
-                    break;
-            }
-            break;
-
-        // * L-Tetromino *
-        case L:
-            switch(rotateAmount%4)
-            {
-                case 0:
-                    shape[0][2] = color;
-                    shape[1][2] = color;
-                    shape[2][2] = color;
-                    shape[2][3] = color;
-                    break;
-                case 1:
-                    if(init)
-                    {
-                        shape[0][1] = color;
-                        shape[0][2] = color;
-                        shape[0][3] = color;
-                        shape[1][1] = color;
-                    }
-                    else
-                    {
-                        shape[1][1] = color;
-                        shape[1][2] = color;
-                        shape[1][3] = color;
-                        shape[2][1] = color;
-                    }
-                    break;
-                case 2:
-                    shape[0][1] = color;
-                    shape[0][2] = color;
-                    shape[1][2] = color;
-                    shape[2][2] = color;
-                    break;
-                case 3:
-                    shape[0][3] = color;
-                    shape[1][1] = color;
-                    shape[1][2] = color;
-                    shape[1][3] = color;
-                    break;
-                default:
-                    break;
-            }
-            break;
-
-        // * T-Tetromino *
-        case T:
-            switch(rotateAmount%4)
-            {
-                case 0:
-                    shape[0][2] = color;
-                    shape[1][1] = color;
-                    shape[1][2] = color;
-                    shape[1][3] = color;
-                    break;
-                case 1:
-                    shape[0][2] = color;
-                    shape[1][2] = color;
-                    shape[1][3] = color;
-                    shape[2][2] = color;
-                    break;
-                case 2:
-                    if(init)
-                    {
-                        shape[0][1] = color;
-                        shape[0][2] = color;
-                        shape[0][3] = color;
-                        shape[1][2] = color;
-                    }
-                    else
-                    {
-                        shape[1][1] = color;
-                        shape[1][2] = color;
-                        shape[1][3] = color;
-                        shape[2][2] = color;
-                    }
-                    break;
-                case 3:
-                    shape[0][2] = color;
-                    shape[1][1] = color;
-                    shape[1][2] = color;
-                    shape[2][2] = color;
-                    break;
-                default:
-                    break;
-            }
-            break;
-
-        // * O-Tetromino *
-        case O:
-            shape[0][2] = color;
-            shape[0][3] = color;
-            shape[1][2] = color;
-            shape[1][3] = color;
-            break;
-
-        // * I-Tetromino *
-        case I:
-            switch(rotateAmount%4)
-            {
-                case 0:
-                    shape[0][2] = color;
-                    shape[1][2] = color;
-                    shape[2][2] = color;
-                    shape[3][2] = color;
-                    break;
-                case 1:
-                    if(init)
-                    {
-                        shape[0][0] = color;
-                        shape[0][1] = color;
-                        shape[0][2] = color;
-                        shape[0][3] = color;
-                    }
-                    else
-                    {
-                        shape[2][0] = color;
-                        shape[2][1] = color;
-                        shape[2][2] = color;
-                        shape[2][3] = color;
-                    }
-                    break;
-                case 2:
-                    shape[0][2] = color;
-                    shape[1][2] = color;
-                    shape[2][2] = color;
-                    shape[3][2] = color;
-                    break;
-                case 3:
-                    shape[2][0] = color;
-                    shape[2][1] = color;
-                    shape[2][2] = color;
-                    shape[2][3] = color;
-                    break;
-                default:
-                    break;
-            }
-            break;
-
-        default: 
-            break;
-    } 
-}
\ No newline at end of file
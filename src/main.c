@@ -7,7 +7,7 @@ static TaskHandle_t BufferSwap = NULL; ///< @ref TaskHandle_t "Task Handle" for
 
 /**
  * @ingroup game
- * @brief Task that updates the screen every 20ms & gives #ScreenLock & #DrawSignal.
+ * @brief Task that draws the last submitted frame every 20ms & gives #DrawSignal.
  */
 static void swapBuffers()
 {
@@ -19,14 +19,11 @@ static void swapBuffers()
 
     while (1)
     {
-        if (xSemaphoreTake(ScreenLock, portMAX_DELAY) == pdTRUE)
-        {
-            tumDrawUpdateScreen();
-            tumEventFetchEvents(FETCH_EVENT_NONBLOCK);
-            xSemaphoreGive(ScreenLock);
-            xSemaphoreGive(DrawSignal);
-            vTaskDelayUntil(&xLastWakeTime, pdMS_TO_TICKS(frameratePeriod));
-        }
+        // Tasks record the next frame meanwhile & hand it over with tumDrawSubmitFrame()
+        tumDrawUpdateScreen();
+        tumEventFetchEvents(FETCH_EVENT_NONBLOCK);
+        xSemaphoreGive(DrawSignal);
+        vTaskDelayUntil(&xLastWakeTime, pdMS_TO_TICKS(frameratePeriod));
     }
 }
 
@@ -27,6 +27,7 @@ static SemaphoreHandle_t HandleUDP      = NULL; ///< @ref SemaphoreHandle_t "Mut
 SemaphoreHandle_t NextTetrominoSignal   = NULL; ///< @ref SemaphoreHandle_t "Signal" for the next Tetromino
 // Queue Handles ********************************************************************
 QueueHandle_t TetrominoQueue            = NULL; ///< @ref QueueHandle_t "Queue" for receiving tetromino types from opponent
+QueueHandle_t SeedQueue                 = NULL; ///< @ref QueueHandle_t "Queue" for the last seed sent to the opponent
 // aIO Handles **********************************************************************
 static aIO_handle_t UDPSocReceive       = NULL; ///< @ref aIO_handle_t "AsyncIO Handle" for receiving data via UDP
 
@@ -49,6 +50,12 @@ static bool parseMode(const char *buffer, game_mode_t *mode);
  */
 static bool parseTetrominoType(const char* buffer, tetromino_type_t *type);
 
+/**
+ * @brief Send a new seed to the opponent & put it in the #SeedQueue, so that the game uses the same seed.
+ * @param[in] buf (char*): Buffer for the message.
+ */
+static void sendSeed(char *buf);
+
 /**
  * @brief Function that reads a game selection from the user.
  * @param[in] buf (char*): String to put the selected game mode in.
@@ -115,8 +122,10 @@ static void vUDPControlTask()
     bool initTetrominoQueue = true;
     // Queue & Signal
     TetrominoQueue      = xQueueCreate(2, sizeof(tetromino_type_t));
+    SeedQueue           = xQueueCreate(1, sizeof(int));
     NextTetrominoSignal = xSemaphoreCreateBinary();
     if(!TetrominoQueue)         exit(EXIT_FAILURE);
+    if(!SeedQueue)              exit(EXIT_FAILURE);
     if(!NextTetrominoSignal)    exit(EXIT_FAILURE);
     // Socket
     UDPSocReceive = aIOOpenUDPSocket(NULL, UDP_RECEIVE_PORT, UDP_BUFFER_SIZE, UDPHandler, NULL);
@@ -131,9 +140,7 @@ static void vUDPControlTask()
         // If the user resets the game, a new seed is generated & the TetrominoQueue is reset
         if(xSemaphoreTake(ResetUDPSignal, 0) == pdTRUE)
         {
-            int seed = time(NULL);
-            sprintf(buf, "SEED=%d", seed);
-            aIOSocketPut(UDP, NULL, UDP_TRANSMIT_PORT, buf, strlen(buf));
+            sendSeed(buf);
             initTetrominoQueue = true;
             xQueueReset(TetrominoQueue);
             xSemaphoreGive(NextTetrominoSignal);
@@ -143,9 +150,7 @@ static void vUDPControlTask()
         // a new seed is set & the game mode is checked every iteration
         if(xSemaphoreTake(NoConnectionSignal, 0) == pdTRUE)
         {
-            int seed = time(NULL);
-            sprintf(buf, "SEED=%d", seed);
-            aIOSocketPut(UDP, NULL, UDP_TRANSMIT_PORT, buf, strlen(buf));
+            sendSeed(buf);
             sprintf(buf, "MODE");
             aIOSocketPut(UDP, NULL, UDP_TRANSMIT_PORT, buf, strlen(buf));
         }
@@ -179,6 +184,14 @@ static void vUDPControlTask()
     }
 }
 
+static void sendSeed(char *buf)
+{
+    int seed = time(NULL);
+    sprintf(buf, "SEED=%d", seed);
+    aIOSocketPut(UDP, NULL, UDP_TRANSMIT_PORT, buf, strlen(buf));
+    xQueueOverwrite(SeedQueue, &seed);
+}
+
 static bool parseMode(const char *buffer, game_mode_t *mode)
 {
     if(!strcmp(buffer, "MODE=FAIR"))            *mode = FAIR;
@@ -197,7 +197,7 @@ int iCheckStateInput(player_mode_t playerMode, bool isConnected, rotation_t rota
         // Switch to GameTask ifMainMenuTask is running.
         // Only possible if rotation & playerMode are selected (&connected in multiplayer mode)
         if( eTaskGetState(MainMenuTask) == eRunning &&
-            ((playerMode == MULTI_PLAYER && isConnected) || playerMode == SINGLE_PLAYER) &&
+            ((playerMode == MULTI_PLAYER && isConnected) || playerMode == SINGLE_PLAYER || playerMode == AI_PLAYER) &&
             rotationMode != NO_ROTATION &&
             bGameDebounceButton(buttons.buttons[SDL_SCANCODE_S], &debounceS.lastState)) 
         {
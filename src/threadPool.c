@@ -0,0 +1,294 @@
+#include "threadPool.h"
+
+#include <pthread.h>
+#include <signal.h>
+#include <unistd.h>
+
+/**
+ * @ingroup pool
+ * @brief Range of indices, that a worker has not run yet.
+ */
+typedef struct worker_range
+{
+    pthread_mutex_t lock;   ///< Mutex, since other workers can steal from the range
+    int begin;              ///< First index of the range
+    int end;                ///< Index after the last index of the range
+} worker_range_t;
+
+/**
+ * @ingroup pool
+ * @brief Arguments of a worker thread.
+ */
+typedef struct worker_args
+{
+    thread_pool_t *pool;    ///< The thread pool
+    int id;                 ///< Index of the worker
+} worker_args_t;
+
+struct thread_pool
+{
+    int workers;                ///< Number of workers, including the calling thread
+    pthread_t *threads;         ///< Threads of workers 1 to workers-1
+    worker_args_t *args;        ///< Arguments of the threads
+    worker_range_t *ranges;     ///< Ranges of all workers
+
+    pthread_mutex_t lock;       ///< Mutex for the following members
+    pthread_cond_t start;       ///< Signaled when a new parallel for-loop starts
+    pthread_cond_t done;        ///< Signaled when the last thread finished a loop
+    unsigned int generation;    ///< Number of the current parallel for-loop
+    int active;                 ///< Number of threads still running the current loop
+    bool stop;                  ///< Whether the threads should exit
+
+    pool_job_t job;             ///< Job of the current loop
+    void *jobArgs;              ///< Arguments of the current job
+};
+
+// **********************************************************************************
+// Forward Declarations *************************************************************
+// **********************************************************************************
+/**
+ * @ingroup pool
+ * @brief Thread function of workers 1 to workers-1.
+ * @param[in] args (void*): The @ref worker_args_t of the thread.
+ * @return (void*): NULL.
+ */
+static void *workerThread(void *args);
+
+/**
+ * @ingroup pool
+ * @brief Run the job for the indices of worker @p id & steal indices from other workers, until none are left.
+ * @param[in] pool ( @ref thread_pool_t *): The thread pool.
+ * @param[in] id (int): Index of the worker.
+ */
+static void runRanges(thread_pool_t *pool, int id);
+
+/**
+ * @ingroup pool
+ * @brief Take the next index from @p range.
+ * @param[in] range ( @ref worker_range_t *): Range to take the index from.
+ * @return (int): The index, -1 if the range is empty.
+ */
+static int popIndex(worker_range_t *range);
+
+/**
+ * @ingroup pool
+ * @brief Steal the upper half of the indices of another worker & put it in the range of worker @p id.
+ * @param[in] pool ( @ref thread_pool_t *): The thread pool.
+ * @param[in] id (int): Index of the stealing worker.
+ * @return (bool): Whether any indices were stolen.
+ */
+static bool stealRange(thread_pool_t *pool, int id);
+
+// **********************************************************************************
+// Function Definitions *************************************************************
+// **********************************************************************************
+thread_pool_t *pxThreadPoolCreate(int workers)
+{
+    if(workers <= 0)
+        workers = sysconf(_SC_NPROCESSORS_ONLN);
+    if(workers <= 0)
+        workers = 1;
+
+    thread_pool_t *pool = calloc(1, sizeof *pool);
+    if(!pool)
+    {
+        PRINT_ERROR("Failed to allocate thread pool");
+        goto err_pool;
+    }
+    pool->workers = workers;
+    pool->threads = calloc(workers, sizeof *pool->threads);
+    pool->args = calloc(workers, sizeof *pool->args);
+    pool->ranges = calloc(workers, sizeof *pool->ranges);
+    if(!pool->threads || !pool->args || !pool->ranges)
+    {
+        PRINT_ERROR("Failed to allocate thread pool workers");
+        goto err_workers;
+    }
+
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->start, NULL);
+    pthread_cond_init(&pool->done, NULL);
+    for(int i=0; i<workers; i++)
+        pthread_mutex_init(&pool->ranges[i].lock, NULL);
+
+    // The threads inherit the signal mask, so all signals are blocked while creating them
+    sigset_t allSignals, prevSignals;
+    sigfillset(&allSignals);
+    pthread_sigmask(SIG_SETMASK, &allSignals, &prevSignals);
+
+    int created = 1;
+    for(; created<workers; created++)
+    {
+        pool->args[created] = (worker_args_t){ pool, created };
+        if(pthread_create(&pool->threads[created], NULL, workerThread, &pool->args[created]))
+        {
+            PRINT_ERROR("Failed to create worker thread %d", created);
+            break;
+        }
+    }
+    pthread_sigmask(SIG_SETMASK, &prevSignals, NULL);
+    if(created < workers)
+        goto err_threads;
+
+    return pool;
+
+    err_threads:
+        pthread_mutex_lock(&pool->lock);
+        pool->stop = true;
+        pthread_cond_broadcast(&pool->start);
+        pthread_mutex_unlock(&pool->lock);
+        for(int i=1; i<created; i++)
+            pthread_join(pool->threads[i], NULL);
+    err_workers:
+        free(pool->ranges);
+        free(pool->args);
+        free(pool->threads);
+        free(pool);
+    err_pool:
+        return NULL;
+}
+
+void vThreadPoolDelete(thread_pool_t *pool)
+{
+    if(!pool)
+        return;
+
+    pthread_mutex_lock(&pool->lock);
+    pool->stop = true;
+    pthread_cond_broadcast(&pool->start);
+    pthread_mutex_unlock(&pool->lock);
+
+    for(int i=1; i<pool->workers; i++)
+        pthread_join(pool->threads[i], NULL);
+
+    for(int i=0; i<pool->workers; i++)
+        pthread_mutex_destroy(&pool->ranges[i].lock);
+    pthread_cond_destroy(&pool->done);
+    pthread_cond_destroy(&pool->start);
+    pthread_mutex_destroy(&pool->lock);
+    free(pool->ranges);
+    free(pool->args);
+    free(pool->threads);
+    free(pool);
+}
+
+int iThreadPoolGetWorkers(const thread_pool_t *pool)
+{
+    return pool->workers;
+}
+
+void vThreadPoolParallelFor(thread_pool_t *pool, int count, pool_job_t job, void *args)
+{
+    if(count <= 0)
+        return;
+
+    // Split the indices evenly between the workers
+    for(int i=0; i<pool->workers; i++)
+    {
+        pool->ranges[i].begin = (long)count * i / pool->workers;
+        pool->ranges[i].end = (long)count * (i+1) / pool->workers;
+    }
+
+    // Start the threads
+    pthread_mutex_lock(&pool->lock);
+    pool->job = job;
+    pool->jobArgs = args;
+    pool->active = pool->workers - 1;
+    pool->generation++;
+    pthread_cond_broadcast(&pool->start);
+    pthread_mutex_unlock(&pool->lock);
+
+    // The calling thread is worker 0
+    runRanges(pool, 0);
+
+    // Wait for the threads to finish
+    pthread_mutex_lock(&pool->lock);
+    while(pool->active)
+        pthread_cond_wait(&pool->done, &pool->lock);
+    pthread_mutex_unlock(&pool->lock);
+}
+
+static void *workerThread(void *args)
+{
+    thread_pool_t *pool = ((worker_args_t*)args)->pool;
+    int id = ((worker_args_t*)args)->id;
+    unsigned int generation = 0;
+
+    while(1)
+    {
+        // Wait for the next parallel for-loop
+        pthread_mutex_lock(&pool->lock);
+        while(!pool->stop && pool->generation == generation)
+            pthread_cond_wait(&pool->start, &pool->lock);
+        if(pool->stop)
+        {
+            pthread_mutex_unlock(&pool->lock);
+            break;
+        }
+        generation = pool->generation;
+        pthread_mutex_unlock(&pool->lock);
+
+        runRanges(pool, id);
+
+        // The last thread to finish wakes up the calling thread
+        pthread_mutex_lock(&pool->lock);
+        if(--pool->active == 0)
+            pthread_cond_signal(&pool->done);
+        pthread_mutex_unlock(&pool->lock);
+    }
+    return NULL;
+}
+
+static void runRanges(thread_pool_t *pool, int id)
+{
+    while(1)
+    {
+        int index = popIndex(&pool->ranges[id]);
+        if(index < 0)
+        {
+            if(!stealRange(pool, id))
+                return;
+            continue;
+        }
+        pool->job(index, id, pool->jobArgs);
+    }
+}
+
+static int popIndex(worker_range_t *range)
+{
+    int index = -1;
+    pthread_mutex_lock(&range->lock);
+    if(range->begin < range->end)
+        index = range->begin++;
+    pthread_mutex_unlock(&range->lock);
+    return index;
+}
+
+static bool stealRange(thread_pool_t *pool, int id)
+{
+    for(int i=1; i<pool->workers; i++)
+    {
+        worker_range_t *victim = &pool->ranges[(id + i) % pool->workers];
+        int begin = 0, end = 0;
+
+        // Take the upper half, a single remaining index is taken as well
+        pthread_mutex_lock(&victim->lock);
+        if(victim->begin < victim->end)
+        {
+            begin = victim->begin + (victim->end - victim->begin) / 2;
+            end = victim->end;
+            victim->end = begin;
+        }
+        pthread_mutex_unlock(&victim->lock);
+
+        if(begin < end)
+        {
+            pthread_mutex_lock(&pool->ranges[id].lock);
+            pool->ranges[id].begin = begin;
+            pool->ranges[id].end = end;
+            pthread_mutex_unlock(&pool->ranges[id].lock);
+            return true;
+        }
+    }
+    return false;
+}
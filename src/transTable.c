@@ -0,0 +1,75 @@
+#include "transTable.h"
+
+#include <stdatomic.h>
+
+/**
+ * @ingroup table
+ * @brief Entry of a transposition table.
+ */
+typedef struct table_entry
+{
+    _Atomic uint64_t check;     ///< XOR of the key & the data
+    _Atomic uint64_t data;      ///< The data
+} table_entry_t;
+
+struct trans_table
+{
+    table_entry_t *entries;     ///< All entries
+    uint64_t mask;              ///< Number of entries-1, to map a key to its entry
+};
+
+// **********************************************************************************
+// Function Definitions *************************************************************
+// **********************************************************************************
+trans_table_t *pxTransTableCreate(int bits)
+{
+    if(bits < 1 || bits > 30)
+        return NULL;
+
+    trans_table_t *table = malloc(sizeof *table);
+    if(!table)
+        goto err_table;
+    table->mask = ((uint64_t)1 << bits) - 1;
+    table->entries = calloc(table->mask + 1, sizeof *table->entries);
+    if(!table->entries)
+        goto err_entries;
+
+    return table;
+
+    err_entries:
+        free(table);
+    err_table:
+        return NULL;
+}
+
+void vTransTableDelete(trans_table_t *table)
+{
+    if(!table)
+        return;
+    free(table->entries);
+    free(table);
+}
+
+void vTransTableClear(trans_table_t *table)
+{
+    memset(table->entries, 0, (table->mask + 1) * sizeof *table->entries);
+}
+
+bool bTransTableLookup(const trans_table_t *table, uint64_t key, uint64_t *data)
+{
+    table_entry_t *entry = &table->entries[key & table->mask];
+    uint64_t value = atomic_load_explicit(&entry->data, memory_order_relaxed);
+    uint64_t check = atomic_load_explicit(&entry->check, memory_order_relaxed);
+    // An empty or torn entry does not match
+    if((check ^ value) != key || !(check | value))
+        return false;
+    *data = value;
+    return true;
+}
+
+void vTransTableStore(trans_table_t *table, uint64_t key, uint64_t data)
+{
+    table_entry_t *entry = &table->entries[key & table->mask];
+    atomic_store_explicit(&entry->check, key ^ data, memory_order_relaxed);
+    atomic_store_explicit(&entry->data, data, memory_order_relaxed);
+}
@@ -0,0 +1,394 @@
+/**
+ * @file simulator.c
+ * 
+ * @authors Philipp Karg (philipp.karg@tum.de)
+ * 
+ * @brief Batch simulator running many headless games on all CPU cores.
+ * @date 16.10.2026
+ * @copyright Philipp Karg 2022
+ */
+
+/**
+ * @defgroup simulator Batch Simulator
+ * @ingroup tetris
+ * @brief Executable that runs many independent, seeded games without FreeRTOS & SDL.
+ * 
+ * Each game is advanced by the @ref engine "Engine" with a random player or the @ref ai "AI",
+ * while the Tetromino types are generated like the opponent executable does for each of its modes.
+ * The games are distributed on all CPU cores with the @ref pool "Thread Pool".
+ * Afterwards, the rows cleared, the score distribution, the game length
+ * & the number of simulated Tetrominos per second are printed for each mode.
+ * 
+ * Usage: `tetris_sim [-n GAMES] [-m MODE] [-t THREADS] [-s SEED] [-l LEVEL] [-a] [-d DEPTH] [-w WIDTH] [-c WEIGHTS]`
+ * 
+ * @authors Philipp Karg (philipp.karg@tum.de)
+ * @date 16.10.2026
+ * @copyright Philipp Karg 2022
+ * @{
+ */
+
+#include <getopt.h>
+#include <inttypes.h>
+#include <strings.h>
+
+#include "ai.h"
+#include "threadPool.h"
+
+/**
+ * @name Simulator Definitions
+ * @{
+ */
+#define DEFAULT_GAMES 10000     ///< Default number of games per mode
+#define FRAME_TIME 20           ///< Simulated time of one step in ms, like the game's frame rate
+#define MAX_STEPS 1000000       ///< Upper bound for the steps of one game
+#define TYPES_IN_BAG 7          ///< Number of Tetromino types
+///@}
+
+/**
+ * @brief State of a simulated opponent, generating Tetromino types for one game.
+ */
+typedef struct opponent
+{
+    game_mode_t mode;                   ///< Mode of the opponent
+    unsigned int seed;                  ///< State of rand_r()
+    tetromino_type_t bag[TYPES_IN_BAG]; ///< Remaining types in #FAIR mode
+    int remaining;                      ///< Number of remaining types in #FAIR mode
+    int index;                          ///< Current index in #DETERMINISTIC mode
+} opponent_t;
+
+/**
+ * @brief Result of one simulated game.
+ */
+typedef struct game_result
+{
+    uint32_t score;     ///< Final score
+    uint32_t rows;      ///< Rows cleared
+    uint32_t pieces;    ///< Number of Tetrominos that landed
+    uint32_t steps;     ///< Number of steps until the game was over
+} game_result_t;
+
+/**
+ * @brief Arguments of simulateGame().
+ */
+typedef struct batch
+{
+    game_mode_t mode;           ///< Mode of the opponent
+    unsigned int seed;          ///< Seed of the batch, each game's seed is derived from it
+    uint8_t level;              ///< Starting level
+    bool ai;                    ///< Whether the games are played by the AI instead of the random player
+    ai_weights_t weights;       ///< Weights of the AI
+    ai_search_t **searches;     ///< Beam search of each worker, NULL if the AI only rates the current Tetromino
+    game_result_t *results;     ///< Results of all games of the batch
+} batch_t;
+
+/// Order of the types the opponent picks from
+static const tetromino_type_t opponentTypes[TYPES_IN_BAG] = { O, I, L, J, T, S, Z };
+/// Sequence the opponent uses in #DETERMINISTIC mode
+static const tetromino_type_t deterministicTypes[TYPES_IN_BAG] = { O, S, T, I, J, Z, L };
+/// Names of the modes, indexed by @ref game_mode_t
+static const char *modeNames[] = { "NONE", "FAIR", "EASY", "HARD", "RANDOM", "DETERMINISTIC" };
+
+// **********************************************************************************
+// Opponent *************************************************************************
+// **********************************************************************************
+/**
+ * @brief Initialize a simulated opponent.
+ * @param[out] opponent ( @ref opponent_t *): Opponent to initialize.
+ * @param[in] mode ( @ref game_mode_t): Mode of the opponent.
+ * @param[in] seed (unsigned int): Seed of the opponent.
+ */
+static void initOpponent(opponent_t *opponent, game_mode_t mode, unsigned int seed)
+{
+    *opponent = (opponent_t){ .mode = mode, .seed = seed };
+    if(mode == DETERMINISTIC)
+        opponent->index = rand_r(&opponent->seed) % TYPES_IN_BAG;
+}
+
+/**
+ * @brief Generate the next Tetromino type, the same way the opponent executable does.
+ * 
+ * - #FAIR: Every type once per 7 types, the opponent hands out the bag in a fixed order.
+ * - #EASY: 70% O, I, L & J, 30% T, S & Z.
+ * - #HARD: 30% O, I, L & J, 70% T, S & Z.
+ * - #RANDOM: Every type with the same probability.
+ * - #DETERMINISTIC: A fixed sequence starting at a random position.
+ * @param[inout] opponent ( @ref opponent_t *): The opponent.
+ * @return ( @ref tetromino_type_t): The next type.
+ */
+static tetromino_type_t nextType(opponent_t *opponent)
+{
+    tetromino_type_t type = NO_TYPE;
+    switch(opponent->mode)
+    {
+        case FAIR:
+            if(!opponent->remaining)
+            {
+                memcpy(opponent->bag, opponentTypes, sizeof(opponent->bag));
+                opponent->remaining = TYPES_IN_BAG;
+            }
+            // The opponent draws a random number, but always takes the last type left in the bag
+            rand_r(&opponent->seed);
+            type = opponent->bag[--opponent->remaining];
+            break;
+        case EASY:
+        case HARD:
+        {
+            int percentage = (opponent->mode == EASY) ? 70 : 30;
+            if(rand_r(&opponent->seed) % 100 < percentage)
+                type = opponentTypes[rand_r(&opponent->seed) % 4];
+            else
+                type = opponentTypes[4 + rand_r(&opponent->seed) % 3];
+            break;
+        }
+        case RANDOM:
+            type = opponentTypes[rand_r(&opponent->seed) % TYPES_IN_BAG];
+            break;
+        case DETERMINISTIC:
+            type = deterministicTypes[opponent->index];
+            opponent->index = (opponent->index + 1) % TYPES_IN_BAG;
+            break;
+        default:
+            break;
+    }
+    return type;
+}
+
+// **********************************************************************************
+// Simulation ***********************************************************************
+// **********************************************************************************
+/**
+ * @brief Random player, that presses a button in every fourth step on average.
+ * @param[inout] seed (unsigned int*): State of rand_r().
+ * @return ( @ref game_input_t): The pressed buttons.
+ */
+static game_input_t randomInput(unsigned int *seed)
+{
+    int r = rand_r(seed);
+    if(r % 4)
+        return 0;
+    return 1 << ((r / 4) % 4);
+}
+
+/**
+ * @brief Simulate game number @p index of a batch, used as @ref pool_job_t.
+ * @param[in] index (int): Index of the game.
+ * @param[in] worker (int): Index of the worker, to pick its beam search.
+ * @param[in] args (void*): The @ref batch_t.
+ */
+static void simulateGame(int index, int worker, void *args)
+{
+    batch_t *batch = args;
+    unsigned int seed = batch->seed ^ (index * 2654435761u);
+    opponent_t opponent;
+    initOpponent(&opponent, batch->mode, seed);
+
+    // The types are fed to the engine like in multiplayer mode
+    game_state_t state;
+    tetromino_type_t types[2] = { nextType(&opponent), nextType(&opponent) };
+    vEngineInit(&state, MULTI_PLAYER, RIGHT, batch->level, types, seed);
+
+    // The player uses a different sequence than the opponent
+    seed = ~seed;
+    ai_player_t ai;
+    vAIInit(&ai, &batch->weights, batch->searches ? batch->searches[worker] : NULL);
+    game_result_t *result = &batch->results[index];
+    *result = (game_result_t){ 0 };
+    while(result->steps < MAX_STEPS)
+    {
+        if(state.pendingType == NO_TYPE)
+            state.pendingType = nextType(&opponent);
+        game_input_t input = batch->ai ? xAIGetInput(&ai, &state) : randomInput(&seed);
+        if(!bEngineStep(&state, input, FRAME_TIME))
+            break;
+        if(state.events & ENGINE_EVENT_LOCK)
+            result->pieces++;
+        result->steps++;
+    }
+    result->score = state.score.score;
+    result->rows = state.score.rows;
+}
+
+/**
+ * @brief Compare two scores for qsort().
+ * @param[in] a (const void*): First @ref game_result_t.
+ * @param[in] b (const void*): Second @ref game_result_t.
+ * @return (int): Negative, 0 or positive, if the first score is lower, equal or higher.
+ */
+static int compareScores(const void *a, const void *b)
+{
+    uint32_t scoreA = ((const game_result_t*)a)->score;
+    uint32_t scoreB = ((const game_result_t*)b)->score;
+    return (scoreA > scoreB) - (scoreA < scoreB);
+}
+
+/**
+ * @brief Print the aggregate statistics of a batch.
+ * @param[in] mode ( @ref game_mode_t): Mode of the batch.
+ * @param[inout] results ( @ref game_result_t []): Results of the batch, sorted by score afterwards.
+ * @param[in] games (int): Number of games.
+ * @param[in] seconds (double): Wall-clock time of the batch.
+ */
+static void printStats(game_mode_t mode, game_result_t results[], int games, double seconds)
+{
+    uint64_t rows = 0, pieces = 0, steps = 0, score = 0;
+    for(int i=0; i<games; i++)
+    {
+        rows += results[i].rows;
+        pieces += results[i].pieces;
+        steps += results[i].steps;
+        score += results[i].score;
+    }
+    qsort(results, games, sizeof *results, compareScores);
+
+    printf("%s\n", modeNames[mode]);
+    printf("    rows cleared:   %" PRIu64 " total, %.2f per game\n", rows, (double)rows / games);
+    printf("    score:          mean %.1f, min %u, p10 %u, median %u, p90 %u, max %u\n",
+            (double)score / games,
+            results[0].score,
+            results[games/10].score,
+            results[games/2].score,
+            results[games*9/10].score,
+            results[games-1].score);
+    printf("    game length:    %.1f Tetrominos, %.1f s simulated\n",
+            (double)pieces / games, (double)steps * FRAME_TIME / 1000 / games);
+    printf("    throughput:     %.0f Tetrominos/s, %.0f steps/s (%.2f s)\n",
+            pieces / seconds, steps / seconds, seconds);
+}
+
+/**
+ * @brief Get the current time of a monotonic clock.
+ * @return (double): Time in seconds.
+ */
+static double now(void)
+{
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return time.tv_sec + time.tv_nsec * 1e-9;
+}
+
+/**
+ * @brief Print the usage of the simulator.
+ * @param[in] name (const char*): Name of the executable.
+ */
+static void printUsage(const char *name)
+{
+    fprintf(stderr, "Usage: %s [-n GAMES] [-m FAIR|EASY|HARD|RANDOM|DETERMINISTIC] "
+                    "[-t THREADS] [-s SEED] [-l LEVEL] [-a] [-d DEPTH] [-w WIDTH] [-c WEIGHTS]\n", name);
+}
+
+int main(int argc, char *argv[])
+{
+    int games = DEFAULT_GAMES;
+    int threads = 0;
+    int depth = 0, width = AI_BEAM_WIDTH;
+    game_mode_t onlyMode = NO_MODE;
+    batch_t batch = { .seed = time(NULL), .weights = AI_DEFAULT_WEIGHTS };
+
+    int opt;
+    while((opt = getopt(argc, argv, "n:m:t:s:l:ad:w:c:h")) != -1)
+    {
+        switch(opt)
+        {
+            case 'n': games = atoi(optarg); break;
+            case 't': threads = atoi(optarg); break;
+            case 's': batch.seed = strtoul(optarg, NULL, 0); break;
+            case 'l': batch.level = atoi(optarg); break;
+            case 'a': batch.ai = true; break;
+            case 'd': depth = atoi(optarg); batch.ai = true; break;
+            case 'w': width = atoi(optarg); break;
+            case 'c':
+                if(!bAILoadWeights(optarg, &batch.weights))
+                {
+                    PRINT_ERROR("Failed to read weights from %s", optarg);
+                    return EXIT_FAILURE;
+                }
+                batch.ai = true;
+                break;
+            case 'm':
+                for(int i=FAIR; i<=DETERMINISTIC; i++)
+                    if(!strcasecmp(optarg, modeNames[i]))
+                        onlyMode = i;
+                if(onlyMode == NO_MODE)
+                {
+                    printUsage(argv[0]);
+                    return EXIT_FAILURE;
+                }
+                break;
+            default:
+                printUsage(argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+    if(games <= 0)
+    {
+        printUsage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    batch.results = calloc(games, sizeof *batch.results);
+    if(!batch.results)
+    {
+        PRINT_ERROR("Failed to allocate results");
+        goto err_results;
+    }
+    thread_pool_t *pool = pxThreadPoolCreate(threads);
+    if(!pool)
+    {
+        PRINT_ERROR("Failed to create thread pool");
+        goto err_pool;
+    }
+    // The games already run in parallel, so each worker searches on its own without a time limit
+    if(depth > 0)
+    {
+        batch.searches = calloc(iThreadPoolGetWorkers(pool), sizeof *batch.searches);
+        if(!batch.searches)
+        {
+            PRINT_ERROR("Failed to allocate searches");
+            goto err_searches;
+        }
+        for(int i=0; i<iThreadPoolGetWorkers(pool); i++)
+        {
+            batch.searches[i] = pxAISearchCreate(width, depth, 0, NULL);
+            if(!batch.searches[i])
+            {
+                PRINT_ERROR("Failed to create beam search");
+                goto err_search;
+            }
+        }
+    }
+
+    printf("Simulating %d games per mode on %d threads, seed %u\n",
+            games, iThreadPoolGetWorkers(pool), batch.seed);
+    if(batch.ai)
+        printf("Evaluating boards with the %s kernel\n", pcEvaluateGetKernel());
+    for(game_mode_t mode=FAIR; mode<=DETERMINISTIC; mode++)
+    {
+        if(onlyMode != NO_MODE && mode != onlyMode)
+            continue;
+        batch.mode = mode;
+        double start = now();
+        vThreadPoolParallelFor(pool, games, simulateGame, &batch);
+        printStats(mode, batch.results, games, now() - start);
+    }
+
+    if(batch.searches)
+        for(int i=0; i<iThreadPoolGetWorkers(pool); i++)
+            vAISearchDelete(batch.searches[i]);
+    free(batch.searches);
+    vThreadPoolDelete(pool);
+    free(batch.results);
+    return EXIT_SUCCESS;
+
+    err_search:
+        for(int i=0; i<iThreadPoolGetWorkers(pool); i++)
+            vAISearchDelete(batch.searches[i]);
+        free(batch.searches);
+    err_searches:
+        vThreadPoolDelete(pool);
+    err_pool:
+        free(batch.results);
+    err_results:
+        return EXIT_FAILURE;
+}
+
+///@}
@@ -0,0 +1,325 @@
+/**
+ * @file tuner.c
+ *
+ * @authors Philipp Karg (philipp.karg@tum.de)
+ *
+ * @brief Self-play tuner for the weights of the AI's board evaluation.
+ * @date 16.10.2026
+ * @copyright Philipp Karg 2022
+ */
+
+/**
+ * @defgroup tuner Weight Tuner
+ * @ingroup tetris
+ * @brief Executable that tunes the @ref ai_weights_t "weights" of the @ref ai "AI" with the cross-entropy method.
+ *
+ * The weights are sampled from a normal distribution for every generation.
+ * Each candidate plays the same set of seeded single player games with the greedy AI,
+ * distributed on all CPU cores with the @ref pool "Thread Pool", & is rated by the mean number of rows cleared.
+ * The mean & deviation of the distribution are then refitted to the best quarter of the candidates.
+ * The first candidate of every generation is the mean itself, whenever it beats all previous means,
+ * it is written to the weights file, which the game & the @ref simulator "Batch Simulator" read.
+ *
+ * All random numbers are derived from the seed, & every game is rated on its own,
+ * so a run can be reproduced with the same seed regardless of the number of threads.
+ *
+ * Usage: `tetris_tune [-g GENERATIONS] [-p POPULATION] [-n GAMES] [-m TETROMINOS] [-t THREADS] [-s SEED] [-l LEVEL] [-i WEIGHTS] [-o WEIGHTS]`
+ *
+ * @authors Philipp Karg (philipp.karg@tum.de)
+ * @date 16.10.2026
+ * @copyright Philipp Karg 2022
+ * @{
+ */
+
+#include <getopt.h>
+#include <inttypes.h>
+
+#include "ai.h"
+#include "threadPool.h"
+
+/**
+ * @name Tuner Definitions
+ * @{
+ */
+#define DEFAULT_GENERATIONS 20  ///< Default number of generations
+#define DEFAULT_POPULATION 32   ///< Default number of candidates per generation
+#define DEFAULT_GAMES 100       ///< Default number of games per candidate
+#define DEFAULT_TETROMINOS 500  ///< Default number of Tetrominos, after which a game is stopped
+#define ELITE_FRACTION 4        ///< The best 1/ELITE_FRACTION of the candidates are used to refit the distribution
+#define INITIAL_DEVIATION 0.5f  ///< Initial standard deviation of every weight
+#define EXTRA_DEVIATION 0.1f    ///< Noise added to the deviation, decaying with the generations, so it does not collapse too early
+#define FRAME_TIME 20           ///< Simulated time of one step in ms, like the game's frame rate
+///@}
+
+/**
+ * @brief State of a tuning run, also the arguments of playGame().
+ */
+typedef struct tuner
+{
+    int population;             ///< Number of candidates per generation
+    int games;                  ///< Number of games per candidate
+    int tetrominos;             ///< Number of Tetrominos, after which a game is stopped
+    uint8_t level;              ///< Starting level
+    uint64_t seed;              ///< Seed of the run
+    int generation;             ///< Current generation
+    ai_weights_t *candidates;   ///< Weights of the candidates of the current generation
+    uint32_t *rows;             ///< Rows cleared in each game, @ref tuner_t::games entries per candidate
+} tuner_t;
+
+/**
+ * @brief A candidate & its rating, for sorting.
+ */
+typedef struct rating
+{
+    int candidate;  ///< Index of the candidate
+    double rows;    ///< Mean number of rows cleared
+} rating_t;
+
+// **********************************************************************************
+// Random Numbers *******************************************************************
+// **********************************************************************************
+/**
+ * @brief Generate a uniform random number in (0, 1].
+ * @param[inout] state (uint64_t*): Counter, that is hashed to get the number.
+ * @return (double): The random number.
+ */
+static double uniform(uint64_t *state)
+{
+    return ((ullLogicHashKey((*state)++) >> 11) + 1) * 0x1p-53;
+}
+
+/**
+ * @brief Generate a normally distributed random number with the Box-Muller transform.
+ * @param[inout] state (uint64_t*): Counter, that is hashed to get the number.
+ * @return (float): The random number, with mean 0 & standard deviation 1.
+ */
+static float normal(uint64_t *state)
+{
+    double radius = sqrt(-2 * log(uniform(state)));
+    return radius * cos(2 * M_PI * uniform(state));
+}
+
+// **********************************************************************************
+// Tuning ***************************************************************************
+// **********************************************************************************
+/**
+ * @brief Play game number @p index of the current generation, used as @ref pool_job_t.
+ *
+ * The games of all candidates of one generation use the same seeds,
+ * so that the candidates are compared on the same Tetrominos.
+ * @param[in] index (int): Index of the candidate times the number of games plus the index of the game.
+ * @param[in] worker (int): Index of the worker, unused.
+ * @param[in] args (void*): The @ref tuner_t.
+ */
+static void playGame(int index, int worker, void *args)
+{
+    (void)worker;
+    tuner_t *tuner = args;
+    int candidate = index / tuner->games;
+    uint64_t game = (uint64_t)tuner->generation * tuner->games + index % tuner->games;
+    uint32_t seed = ullLogicHashKey(tuner->seed ^ ullLogicHashKey(game));
+
+    game_state_t state;
+    vEngineInit(&state, SINGLE_PLAYER, RIGHT, tuner->level, NULL, seed);
+    ai_player_t ai;
+    vAIInit(&ai, &tuner->candidates[candidate], NULL);
+
+    int tetrominos = 0;
+    while(tetrominos < tuner->tetrominos && bEngineStep(&state, xAIGetInput(&ai, &state), FRAME_TIME))
+        if(state.events & ENGINE_EVENT_LOCK)
+            tetrominos++;
+    tuner->rows[index] = state.score.rows;
+}
+
+/**
+ * @brief Compare two ratings for qsort(), the best rating first.
+ *
+ * Equal ratings are ordered by the index of the candidate, so the order does not depend on qsort().
+ * @param[in] a (const void*): First @ref rating_t.
+ * @param[in] b (const void*): Second @ref rating_t.
+ * @return (int): Negative, 0 or positive, if the first rating is better, equal or worse.
+ */
+static int compareRatings(const void *a, const void *b)
+{
+    const rating_t *ratingA = a, *ratingB = b;
+    if(ratingA->rows != ratingB->rows)
+        return (ratingA->rows < ratingB->rows) - (ratingA->rows > ratingB->rows);
+    return ratingA->candidate - ratingB->candidate;
+}
+
+/**
+ * @brief Print weights in one line.
+ * @param[in] weights (const @ref ai_weights_t *): The weights.
+ */
+static void printWeights(const ai_weights_t *weights)
+{
+    float values[AI_WEIGHTS];
+    memcpy(values, weights, sizeof values);
+    for(size_t i=0; i<AI_WEIGHTS; i++)
+        printf(" %+.4f", values[i]);
+    printf("\n");
+}
+
+/**
+ * @brief Print the usage of the tuner.
+ * @param[in] name (const char*): Name of the executable.
+ */
+static void printUsage(const char *name)
+{
+    fprintf(stderr, "Usage: %s [-g GENERATIONS] [-p POPULATION] [-n GAMES] [-m TETROMINOS] "
+                    "[-t THREADS] [-s SEED] [-l LEVEL] [-i WEIGHTS] [-o WEIGHTS]\n", name);
+}
+
+int main(int argc, char *argv[])
+{
+    int generations = DEFAULT_GENERATIONS;
+    int threads = 0;
+    const char *output = AI_WEIGHTS_FILE;
+    ai_weights_t initial = AI_DEFAULT_WEIGHTS;
+    tuner_t tuner = {
+        .population = DEFAULT_POPULATION,
+        .games = DEFAULT_GAMES,
+        .tetrominos = DEFAULT_TETROMINOS,
+        .seed = time(NULL),
+    };
+
+    int opt;
+    while((opt = getopt(argc, argv, "g:p:n:m:t:s:l:i:o:h")) != -1)
+    {
+        switch(opt)
+        {
+            case 'g': generations = atoi(optarg); break;
+            case 'p': tuner.population = atoi(optarg); break;
+            case 'n': tuner.games = atoi(optarg); break;
+            case 'm': tuner.tetrominos = atoi(optarg); break;
+            case 't': threads = atoi(optarg); break;
+            case 's': tuner.seed = strtoull(optarg, NULL, 0); break;
+            case 'l': tuner.level = atoi(optarg); break;
+            case 'o': output = optarg; break;
+            case 'i':
+                if(!bAILoadWeights(optarg, &initial))
+                {
+                    PRINT_ERROR("Failed to read weights from %s", optarg);
+                    return EXIT_FAILURE;
+                }
+                break;
+            default:
+                printUsage(argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+    if(generations <= 0 || tuner.population < ELITE_FRACTION || tuner.games <= 0 || tuner.tetrominos <= 0)
+    {
+        printUsage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    tuner.candidates = calloc(tuner.population, sizeof *tuner.candidates);
+    if(!tuner.candidates)
+    {
+        PRINT_ERROR("Failed to allocate candidates");
+        goto err_candidates;
+    }
+    tuner.rows = calloc((size_t)tuner.population * tuner.games, sizeof *tuner.rows);
+    if(!tuner.rows)
+    {
+        PRINT_ERROR("Failed to allocate results");
+        goto err_rows;
+    }
+    rating_t *ratings = calloc(tuner.population, sizeof *ratings);
+    if(!ratings)
+    {
+        PRINT_ERROR("Failed to allocate ratings");
+        goto err_ratings;
+    }
+    thread_pool_t *pool = pxThreadPoolCreate(threads);
+    if(!pool)
+    {
+        PRINT_ERROR("Failed to create thread pool");
+        goto err_pool;
+    }
+
+    // The distribution is tuned as plain vectors, in the order of ai_weights_t
+    float mean[AI_WEIGHTS], deviation[AI_WEIGHTS];
+    memcpy(mean, &initial, sizeof mean);
+    for(size_t i=0; i<AI_WEIGHTS; i++)
+        deviation[i] = INITIAL_DEVIATION;
+    uint64_t random = ullLogicHashKey(tuner.seed);
+    double bestRows = -1;
+
+    printf("Tuning %d candidates with %d games each on %d threads, seed %" PRIu64 "\n",
+            tuner.population, tuner.games, iThreadPoolGetWorkers(pool), tuner.seed);
+    for(tuner.generation=0; tuner.generation<generations; tuner.generation++)
+    {
+        // Sample the candidates, the first one is the mean
+        for(int c=0; c<tuner.population; c++)
+        {
+            float values[AI_WEIGHTS];
+            for(size_t i=0; i<AI_WEIGHTS; i++)
+                values[i] = mean[i] + (c ? deviation[i] * normal(&random) : 0);
+            memcpy(&tuner.candidates[c], values, sizeof values);
+        }
+
+        vThreadPoolParallelFor(pool, tuner.population * tuner.games, playGame, &tuner);
+
+        for(int c=0; c<tuner.population; c++)
+        {
+            uint64_t rows = 0;
+            for(int g=0; g<tuner.games; g++)
+                rows += tuner.rows[c * tuner.games + g];
+            ratings[c] = (rating_t){ c, (double)rows / tuner.games };
+        }
+
+        // Keep the mean, if it beats the means of all previous generations
+        if(ratings[0].rows > bestRows)
+        {
+            bestRows = ratings[0].rows;
+            if(!bAISaveWeights(output, &tuner.candidates[0]))
+            {
+                PRINT_ERROR("Failed to write weights to %s", output);
+                goto err_save;
+            }
+        }
+        printf("generation %2d: mean %.2f rows, best %.2f rows, weights",
+                tuner.generation, ratings[0].rows, bestRows);
+        printWeights(&tuner.candidates[0]);
+
+        // Refit the distribution to the elite
+        qsort(ratings, tuner.population, sizeof *ratings, compareRatings);
+        int elite = tuner.population / ELITE_FRACTION;
+        float extra = EXTRA_DEVIATION / (tuner.generation + 1);
+        for(size_t i=0; i<AI_WEIGHTS; i++)
+        {
+            float sum = 0, squares = 0;
+            for(int e=0; e<elite; e++)
+            {
+                float values[AI_WEIGHTS];
+                memcpy(values, &tuner.candidates[ratings[e].candidate], sizeof values);
+                sum += values[i];
+                squares += values[i] * values[i];
+            }
+            mean[i] = sum / elite;
+            deviation[i] = sqrtf(fmaxf(squares / elite - mean[i] * mean[i], 0)) + extra;
+        }
+    }
+    printf("Best mean: %.2f rows, written to %s\n", bestRows, output);
+
+    vThreadPoolDelete(pool);
+    free(ratings);
+    free(tuner.rows);
+    free(tuner.candidates);
+    return EXIT_SUCCESS;
+
+    err_save:
+        vThreadPoolDelete(pool);
+    err_pool:
+        free(ratings);
+    err_ratings:
+        free(tuner.rows);
+    err_rows:
+        free(tuner.candidates);
+    err_candidates:
+        return EXIT_FAILURE;
+}
+
+///@}